@@ -0,0 +1,142 @@
+#ifndef __Bench_H
+#define __Bench_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Microbenchmark harness
+// ----------------------
+//
+// runBench() calls the function under test a few times to warm up, then
+// takes 'reps' samples. Each sample times a batch of calls that is large
+// enough (about 'sampleNs' nanoseconds) for the clock overhead not to
+// matter, and records the time per call. Results keep min, median, p99,
+// mean and standard deviation in nanoseconds per call, and can be printed
+// as a table, CSV or JSON.
+//
+// Results of the function under test should be passed to doNotOptimize()
+// so that the compiler cannot drop the call.
+
+// Make the compiler believe x is read, so that computing it can't be removed
+template <class T>
+inline void doNotOptimize(const T& x) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(x) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &x;
+#endif
+}
+
+struct BenchResult {
+    std::string name;
+    long calls;        // Calls per sample
+    int reps;          // Number of samples
+    size_t bytes;      // Bytes processed per call (0 if not meaningful)
+    double min, median, p99, mean, stddev;   // ns per call
+};
+
+struct BenchOptions {
+    int warmup = 3;
+    int reps = 30;
+    double sampleNs = 1e6;
+};
+
+// Build a result from samples in ns per call, each timing 'calls' calls.
+// With no samples every statistic is 0.
+inline BenchResult summarize(const std::string& name, long calls, std::vector<double> samples, size_t bytes = 0) {
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult r;
+    r.name = name;
+    r.calls = calls;
+    r.reps = (int)samples.size();
+    r.bytes = bytes;
+    if (samples.empty()) {
+        r.min = r.median = r.p99 = r.mean = r.stddev = 0;
+        return r;
+    }
+    r.min = samples.front();
+    r.median = samples[samples.size() / 2];
+    r.p99 = samples[std::min(samples.size() - 1, (size_t)std::ceil(0.99 * samples.size()) - 1)];
+    r.mean = 0;
+    for (double x : samples) r.mean += x;
+    r.mean /= samples.size();
+    r.stddev = 0;
+    for (double x : samples) r.stddev += (x - r.mean) * (x - r.mean);
+    r.stddev = std::sqrt(r.stddev / samples.size());
+    return r;
+}
+
+// Benchmark f(), which processes 'bytes' bytes per call
+template <class F>
+BenchResult runBench(const std::string& name, F f, const BenchOptions& opt = BenchOptions(), size_t bytes = 0) {
+    typedef std::chrono::steady_clock clock;
+    for (int i = 0; i < opt.warmup; ++ i) f();
+
+    // Find how many calls make a sample of about opt.sampleNs
+    long calls = 1;
+    while (true) {
+        auto start = clock::now();
+        for (long i = 0; i < calls; ++ i) f();
+        double ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(clock::now() - start).count();
+        if (ns >= opt.sampleNs || calls >= (1L << 30)) break;
+        calls *= 2;
+    }
+
+    std::vector<double> samples;
+    for (int r = 0; r < std::max(opt.reps, 1); ++ r) {     // At least one sample
+        auto start = clock::now();
+        for (long i = 0; i < calls; ++ i) f();
+        double ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(clock::now() - start).count();
+        samples.push_back(ns / calls);
+    }
+    return summarize(name, calls, samples, bytes);
+}
+
+// Print results as an aligned table
+inline void printTable(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "benchmark                         min (ns)   median (ns)   p99 (ns)   stddev (ns)   MB/s\n";
+    for (const BenchResult& r : results) {
+        char line[256];
+        snprintf(line, sizeof(line), "%-30s %11.1f %13.1f %10.1f %13.1f %8.1f\n", r.name.c_str(),
+                 r.min, r.median, r.p99, r.stddev, r.bytes ? r.bytes / r.median * 1e3 : 0.0);
+        out << line;
+    }
+}
+
+// Print results as CSV, one line per benchmark
+inline void printCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "name,calls,reps,bytes,min_ns,median_ns,p99_ns,mean_ns,stddev_ns\n";
+    for (const BenchResult& r : results) {
+        out << r.name << "," << r.calls << "," << r.reps << "," << r.bytes << "," << r.min << "," << r.median
+            << "," << r.p99 << "," << r.mean << "," << r.stddev << "\n";
+    }
+}
+
+// Print results as a JSON array
+inline void printJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++ i) {
+        const BenchResult& r = results[i];
+        out << "  {\"name\": \"" << r.name << "\", \"calls\": " << r.calls << ", \"reps\": " << r.reps
+            << ", \"bytes\": " << r.bytes << ", \"min_ns\": " << r.min << ", \"median_ns\": " << r.median
+            << ", \"p99_ns\": " << r.p99 << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+// Print in the format named "table", "csv" or "json"
+inline void printResults(std::ostream& out, const std::vector<BenchResult>& results, const std::string& format) {
+    if (format == "csv") printCsv(out, results);
+    else if (format == "json") printJson(out, results);
+    else printTable(out, results);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef __BenchQueues_H
+#define __BenchQueues_H
+
+#include <cstddef>
+#include <deque>
+#include <queue>
+#include <mutex>
+#include <thread>
+
+#include "queue.h"
+
+// Baselines and helpers shared by the queue benchmarks
+
+// std::deque used directly as a queue
+struct DequeQueue {
+    std::deque<int> d;
+    void push(int x) { d.push_back(x); }
+    void pop() { d.pop_front(); }
+    int front() { return d.front(); }
+    bool empty() { return d.empty(); }
+};
+
+// Queue protected by a mutex, with the same try_ interface as the
+// concurrent queues
+struct MutexQueue {
+    Queue<long> q;
+    std::mutex m;
+    size_t cap;
+
+    MutexQueue(size_t capacity) : cap(capacity) {}
+
+    bool try_push(long x) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.size() == cap) return false;
+        q.push(x);
+        return true;
+    }
+
+    bool try_pop(long& x) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.empty()) return false;
+        x = q.front();
+        q.pop();
+        return true;
+    }
+};
+
+// Spin on a full or empty queue; yield now and then in case threads share
+// a core
+inline void backoff(int& spins) {
+    if (++ spins % 64 == 0) std::this_thread::yield();
+}
+
+// Bounded std::queue protected by a mutex, with the blocking push and pop
+// of MpmcQueue
+struct MutexStdQueue {
+    std::queue<long> q;
+    std::mutex m;
+    size_t cap;
+
+    MutexStdQueue(size_t capacity) : cap(capacity) {}
+
+    bool try_push(long x) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.size() == cap) return false;
+        q.push(x);
+        return true;
+    }
+
+    bool try_pop(long& x) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.empty()) return false;
+        x = q.front();
+        q.pop();
+        return true;
+    }
+
+    void push(long x) {
+        for (int spins = 0; !try_push(x); ) backoff(spins);
+    }
+
+    void pop(long& x) {
+        for (int spins = 0; !try_pop(x); ) backoff(spins);
+    }
+};
+
+#endif
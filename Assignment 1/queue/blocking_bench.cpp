@@ -0,0 +1,107 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <ctime>
+
+#include "blocking_queue.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// CPU time used by the calling thread, in seconds
+double thread_cpu() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+double ns_since(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(Clock::now() - t).count();
+}
+
+// Close, drain and timeout behaviour
+bool check_semantics() {
+    BlockingQueue<int> q(8);
+    long sum = 0;
+    std::thread consumer([&]() {
+        int x;
+        while (q.pop_wait(x)) sum += x;
+    });
+    for (int i = 0; i < 1000; ++ i) q.push_wait(i);
+    q.close();
+    consumer.join();
+    if (sum != 999 * 1000 / 2 || q.push_wait(1)) return false;
+
+    BlockingQueue<int> empty(8);
+    int x;
+    auto start = Clock::now();
+    if (empty.pop_wait_for(x, std::chrono::milliseconds(20))) return false;
+    if (ns_since(start) < 20e6) return false;
+
+    BlockingQueue<int> full(2);
+    full.push_wait(1);
+    full.push_wait(2);
+    return !full.push_wait_for(3, std::chrono::milliseconds(5)) && full.size() == 2;
+}
+
+// Latency from push to the consumer returning from pop_wait. With 'idle'
+// the producer waits 1 ms first, so the consumer is asleep; otherwise the
+// next push follows right away and the consumer is still spinning.
+void wake_latency(bool idle, int n) {
+    BlockingQueue<Clock::time_point> q(16);
+    std::vector<double> ns;
+    std::thread consumer([&]() {
+        Clock::time_point t;
+        while (q.pop_wait(t)) ns.push_back(ns_since(t));
+    });
+    for (int i = 0; i < n; ++ i) {
+        if (idle) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        else while (q.size()) std::this_thread::yield();
+        q.push_wait(Clock::now());
+    }
+    q.close();
+    consumer.join();
+    std::sort(ns.begin(), ns.end());
+    std::cout << (idle ? "wake-up from sleep" : "back-to-back handoff") << ": median " << ns[ns.size() / 2]
+              << " ns, p99 " << ns[ns.size() * 99 / 100] << " ns\n";
+}
+
+// CPU used by a consumer waiting 'ms' milliseconds on an empty queue, with
+// pop_wait_for and with a busy-polling try_pop loop
+void idle_cpu(int ms) {
+    BlockingQueue<int> q(16);
+    double parked = 0, polling = 0;
+    std::thread t1([&]() {
+        double start = thread_cpu();
+        int x;
+        q.pop_wait_for(x, std::chrono::milliseconds(ms));
+        parked = thread_cpu() - start;
+    });
+    t1.join();
+    std::thread t2([&]() {
+        double start = thread_cpu();
+        auto deadline = Clock::now() + std::chrono::milliseconds(ms);
+        int x;
+        while (!q.try_pop(x) && Clock::now() < deadline) {}
+        polling = thread_cpu() - start;
+    });
+    t2.join();
+    std::cout << "CPU while idle for " << ms << " ms: pop_wait_for " << parked * 1e3 << " ms, busy polling "
+              << polling * 1e3 << " ms\n";
+}
+
+int main() {
+
+    if (!check_semantics()) {
+        std::cerr << "BlockingQueue semantics check failed\n";
+        return 1;
+    }
+    wake_latency(true, 1000);
+    wake_latency(false, 100000);
+    idle_cpu(500);
+
+    return 0;
+
+}
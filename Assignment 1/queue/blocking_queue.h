@@ -0,0 +1,181 @@
+#ifndef __BlockingQueue_H
+#define __BlockingQueue_H
+
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+
+#include "queue.h"
+#include "queue_stats.h"
+
+// Number of times a waiting thread re-checks the queue before sleeping
+#define BLOCKING_SPINS 2000
+
+// Bounded queue for producer and consumer threads that wait instead of
+// polling. A Queue holds the elements under a mutex; 'limit' bounds its size,
+// so fast producers are held back until consumers catch up.
+//
+// A thread that has to wait first spins for a short while, reading only an
+// atomic copy of the size, so a handoff that comes quickly costs no sleep or
+// wake-up. After that it sleeps on a condition variable (a futex on Linux)
+// and uses no CPU until it is woken. Notifications are only sent when some
+// thread is actually asleep.
+//
+// close() ends the stream: pushes fail from then on, and pops keep returning
+// the elements left until the queue is drained.
+//
+// With Stats = QueueStats (queue_stats.h) the inner queue records its
+// traffic, and every push refused because the queue is full, closed or
+// timed out counts as rejected.
+template <class T, class Stats = NoQueueStats>
+class BlockingQueue {
+public:
+    Queue<T, Stats> q;
+    size_t limit;
+    std::mutex m;
+    std::condition_variable notEmpty, notFull;
+    std::atomic<size_t> count;      // Copy of q.size() for spinning without the lock
+    std::atomic<bool> closed;
+    int sleepingPop, sleepingPush;  // Threads asleep on notEmpty / notFull
+
+    BlockingQueue(size_t capacity = 1024)
+        : q(capacity), limit(capacity), count(0), closed(false), sleepingPop(0), sleepingPush(0) {}
+
+    // Insert x, waiting while the queue is full. Returns false if the queue
+    // is closed.
+    template <class U>
+    bool push_wait(U&& x) {
+        return push_until(std::forward<U>(x), std::chrono::steady_clock::time_point::max());
+    }
+
+    // Same as push_wait, giving up (and returning false) after 'timeout'
+    template <class U, class Rep, class Period>
+    bool push_wait_for(U&& x, std::chrono::duration<Rep, Period> timeout) {
+        return push_until(std::forward<U>(x), std::chrono::steady_clock::now() + timeout);
+    }
+
+    // Pop the front element into x, waiting while the queue is empty.
+    // Returns false once the queue is closed and drained.
+    bool pop_wait(T& x) {
+        return pop_until(x, std::chrono::steady_clock::time_point::max());
+    }
+
+    // Same as pop_wait, giving up (and returning false) after 'timeout'
+    template <class Rep, class Period>
+    bool pop_wait_for(T& x, std::chrono::duration<Rep, Period> timeout) {
+        return pop_until(x, std::chrono::steady_clock::now() + timeout);
+    }
+
+    // Insert x only if there is room right now
+    template <class U>
+    bool try_push(U&& x) {
+        std::lock_guard<std::mutex> lock(m);
+        if (closed || q.size() >= limit) {
+            q.rejected();
+            return false;
+        }
+        insert(std::forward<U>(x));
+        return true;
+    }
+
+    // Pop only if an element is there right now
+    bool try_pop(T& x) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.empty()) return false;
+        remove(x);
+        return true;
+    }
+
+    // Refuse further pushes and wake every waiting thread
+    void close() {
+        std::lock_guard<std::mutex> lock(m);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    // Statistics so far, taken under the lock (only with Stats = QueueStats)
+    QueueStatsSnapshot snapshot() {
+        std::lock_guard<std::mutex> lock(m);
+        return q.snapshot();
+    }
+
+    template <class U>
+    bool push_until(U&& x, std::chrono::steady_clock::time_point deadline) {
+        for (int i = 0; i < BLOCKING_SPINS && count.load(std::memory_order_relaxed) >= limit && !closed; ++ i) spin_pause();
+        std::unique_lock<std::mutex> lock(m);
+        while (!closed && q.size() >= limit) {
+            ++ sleepingPush;
+            bool timedOut = sleep(notFull, lock, deadline);
+            -- sleepingPush;
+            if (timedOut && q.size() >= limit) {
+                q.rejected();
+                return false;
+            }
+        }
+        if (closed) {
+            q.rejected();
+            return false;
+        }
+        insert(std::forward<U>(x));
+        return true;
+    }
+
+    bool pop_until(T& x, std::chrono::steady_clock::time_point deadline) {
+        for (int i = 0; i < BLOCKING_SPINS && count.load(std::memory_order_relaxed) == 0 && !closed; ++ i) spin_pause();
+        std::unique_lock<std::mutex> lock(m);
+        while (q.empty() && !closed) {
+            ++ sleepingPop;
+            bool timedOut = sleep(notEmpty, lock, deadline);
+            -- sleepingPop;
+            if (timedOut && q.empty()) return false;
+        }
+        if (q.empty()) return false;  // Closed and drained
+        remove(x);
+        return true;
+    }
+
+    // Wait on cv until notified or past 'deadline'; true if timed out
+    static bool sleep(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                      std::chrono::steady_clock::time_point deadline) {
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            cv.wait(lock);
+            return false;
+        }
+        return cv.wait_until(lock, deadline) == std::cv_status::timeout;
+    }
+
+    // Called with the lock held
+    template <class U>
+    void insert(U&& x) {
+        q.push(std::forward<U>(x));
+        count.store(q.size(), std::memory_order_relaxed);
+        if (sleepingPop) notEmpty.notify_one();
+    }
+
+    void remove(T& x) {
+        x = std::move(q.front());
+        q.pop();
+        count.store(q.size(), std::memory_order_relaxed);
+        if (sleepingPush) notFull.notify_one();
+    }
+
+    static void spin_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+};
+
+#endif
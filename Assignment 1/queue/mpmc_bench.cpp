@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "mpmc_queue.h"
+#include "bench_queues.h"
+
+// Pass n items from 'producers' threads to 'consumers' threads; returns
+// items per second, or -1 if an item was lost or duplicated
+template <class Q>
+double run(int producers, int consumers, long n) {
+    Q q(1024);
+    std::atomic<long> sum(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock ::now();
+    for (int p = 0; p < producers; ++ p) {
+        threads.emplace_back([&, p]() {
+            for (long i = p; i < n; i += producers) q.push(i);
+        });
+    }
+    for (int c = 0; c < consumers; ++ c) {
+        threads.emplace_back([&, c]() {
+            long local = 0, x;
+            for (long i = c; i < n; i += consumers) {
+                q.pop(x);
+                local += x;
+            }
+            sum += local;
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    auto stop = std::chrono::steady_clock ::now();
+    if (sum != n * (n - 1) / 2) return -1;
+    return n / std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+}
+
+// Usage: mpmc_bench [items]
+// Sweeps 1 to 4 producers and consumers and compares MpmcQueue with a
+// mutex-protected std::queue
+int main(int argc, char* argv[]) {
+
+    long n = argc > 1 ? atol(argv[1]) : 10000000;
+    std::cout << "producers\tconsumers\tMpmcQueue (Mops/s)\tmutex std::queue (Mops/s)\n";
+    for (int p : {1, 2, 4}) {
+        for (int c : {1, 2, 4}) {
+            double lockFree = run<MpmcQueue<long>>(p, c, n);
+            double locked = run<MutexStdQueue>(p, c, n);
+            if (lockFree < 0 || locked < 0) {
+                std::cerr << "Items were lost with " << p << " producers and " << c << " consumers\n";
+                return 1;
+            }
+            std::cout << p << "\t\t" << c << "\t\t" << lockFree / 1e6 << "\t\t\t" << locked / 1e6 << "\n";
+        }
+    }
+
+    return 0;
+
+}
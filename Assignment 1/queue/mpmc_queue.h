@@ -0,0 +1,124 @@
+#ifndef __MpmcQueue_H
+#define __MpmcQueue_H
+
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <new>
+#include <utility>
+
+#include "queue.h"
+
+// Bounded lock-free queue for any number of producers and consumers
+// (Dmitry Vyukov's design).
+//
+// Like Queue this is a power-of-two ring with an end index e (where the
+// next push goes) and a front index f (where the next pop comes from), both
+// counting up and masked on access. Every cell also has a sequence number
+// telling whose turn it is:
+//
+//   seq == pos          the cell is free for the push at position pos
+//   seq == pos + 1      the cell holds the element pushed at pos
+//
+// A producer claims position e with a compare-and-swap, fills the cell and
+// sets seq to pos + 1; a consumer claims f the same way and, after moving
+// the element out, sets seq to pos + cap, freeing the cell for the next lap.
+// Threads only contend on the index they advance, and on a cell when the
+// queue is full or empty. f and e are on separate cache lines.
+template <class T>
+class MpmcQueue {
+public:
+    struct Cell {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char data[sizeof(T)];
+
+        T* elem() {
+            return (T*)data;
+        }
+    };
+
+    alignas(CACHE_LINE) std::atomic<size_t> e;
+    alignas(CACHE_LINE) std::atomic<size_t> f;
+    alignas(CACHE_LINE) size_t cap;
+    Cell* cells;
+
+    MpmcQueue(size_t capacity = 1024) : e(0), f(0), cap(2) {
+        while (cap < capacity) cap *= 2;
+        cells = new Cell[cap];
+        for (size_t i = 0; i < cap; ++ i) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() {
+        for (size_t pos = f.load(); pos != e.load(); ++ pos) cells[pos & (cap - 1)].elem()->~T();
+        delete[] cells;
+    }
+
+    // Insert x unless the queue is full
+    template <class U>
+    bool try_push(U&& x) {
+        size_t pos = e.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& c = cells[pos & (cap - 1)];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            long diff = (long)(seq - pos);
+            if (diff == 0) {
+                if (e.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (c.data) T(std::forward<U>(x));
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) return false;   // The cell is still full from the last lap
+            else pos = e.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Move the front element to x unless the queue is empty
+    bool try_pop(T& x) {
+        size_t pos = f.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& c = cells[pos & (cap - 1)];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            long diff = (long)(seq - (pos + 1));
+            if (diff == 0) {
+                if (f.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    x = std::move(*c.elem());
+                    c.elem()->~T();
+                    c.seq.store(pos + cap, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) return false;   // Nothing pushed at pos yet
+            else pos = f.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Insert x, waiting while the queue is full
+    template <class U>
+    void push(U&& x) {
+        for (int spins = 0; !try_push(std::forward<U>(x)); ++ spins) {
+            if (spins >= 64) std::this_thread::yield();
+        }
+    }
+
+    // Pop the front element into x, waiting while the queue is empty
+    void pop(T& x) {
+        for (int spins = 0; !try_pop(x); ++ spins) {
+            if (spins >= 64) std::this_thread::yield();
+        }
+    }
+
+    // Number of elements; only a snapshot while other threads are running
+    size_t size() const {
+        size_t end = e.load(std::memory_order_acquire), front = f.load(std::memory_order_acquire);
+        return end > front ? end - front : 0;
+    }
+
+    size_t capacity() const {
+        return cap;
+    }
+
+};
+
+#endif
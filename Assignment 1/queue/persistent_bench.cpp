@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "persistent_queue.h"
+
+struct Record {
+    long id;
+    long payload[7];
+};
+
+// Push n records with write-back every 'interval' operations (0 = never),
+// popping whenever the queue is half full; returns the push latencies in ns, sorted
+std::vector<double> durable_push(const std::string& path, long n, size_t interval) {
+    std::remove(path.c_str());
+    PersistentQueue<Record> q(path, 4096, interval);
+    std::vector<double> ns;
+    ns.reserve(n);
+    Record r = {};
+    for (long i = 0; i < n; ++ i) {
+        if (q.size() == q.capacity() / 2) q.pop();
+        r.id = i;
+        auto start = std::chrono::steady_clock ::now();
+        q.push(r);
+        auto stop = std::chrono::steady_clock ::now();
+        ns.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count());
+    }
+    std::sort(ns.begin(), ns.end());
+    return ns;
+}
+
+// Reopen the file and check that the queue holds the last records pushed
+bool recovers(const std::string& path, long n) {
+    PersistentQueue<Record> q(path, 4096);
+    long expect = n - (long)q.size();
+    for (; !q.empty(); q.pop(), ++ expect) {
+        if (q.front().id != expect) return false;
+    }
+    return expect == n;
+}
+
+// Kill a process pushing with no write-back at 'rounds' random moments, and
+// check after each kill that the file reopens with consecutive records
+bool survivesKill(const std::string& path, int rounds) {
+    std::remove(path.c_str());
+    for (int round = 0; round < rounds; ++ round) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            PersistentQueue<Record> q(path, 4096);
+            Record r = {};
+            r.id = q.empty() ? 0 : q.front().id + (long)q.size();
+            for (;; ++ r.id) {
+                if (q.size() == q.capacity() / 2) q.pop();
+                q.push(r);
+            }
+        }
+        usleep(1000 + rand() % 20000);
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+
+        PersistentQueue<Record> q(path, 4096);
+        if (q.empty()) continue;
+        long expect = q.front().id;
+        for (; !q.empty(); q.pop(), ++ expect) {
+            if (q.front().id != expect) return false;
+        }
+    }
+    std::remove(path.c_str());
+    return true;
+}
+
+// Usage: persistent_bench [pushes] [file]
+// Durable push latency of PersistentQueue at several write-back intervals
+int main(int argc, char* argv[]) {
+
+    long n = argc > 1 ? atol(argv[1]) : 20000;
+    std::string path = argc > 2 ? argv[2] : "persistent_bench.q";
+
+    std::cout << "interval\tmean ns\tmedian ns\tp99 ns\trecovered\n";
+    for (size_t interval : {1, 8, 64, 512, 4096, 0}) {
+        std::vector<double> ns = durable_push(path, n, interval);
+        double sum = 0;
+        for (double x : ns) sum += x;
+        std::cout << (interval ? std::to_string(interval) : "never") << "\t" << sum / n << "\t"
+                  << ns[ns.size() / 2] << "\t" << ns[ns.size() * 99 / 100] << "\t"
+                  << (recovers(path, n) ? "yes" : "NO") << "\n";
+    }
+    std::remove(path.c_str());
+
+    std::cout << "survives kill -9: " << (survivesKill(path, 50) ? "yes" : "NO") << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,261 @@
+#ifndef __PersistentQueue_H
+#define __PersistentQueue_H
+
+#include <cstddef>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Tag at the start of every queue file
+#define PQUEUE_MAGIC 0x5155455545504f44ULL
+
+// Seed of the FNV-1a hashes below
+#define PQUEUE_FNV_SEED 1469598103934665603ULL
+
+// File-backed queue that survives restarts
+// ----------------------------------------
+//
+// The same ring as Queue, but the cells live in a file mapped with mmap:
+//
+//   +--------+-------------------------------------------+
+//   | header | cap cells of sizeof(T) bytes               |
+//   +--------+-------------------------------------------+
+//
+// The header holds the capacity, the element size and two copies ("slots")
+// of the queue state, each with a sequence number and a checksum. An
+// operation writes its state to the older slot, so a process killed in the
+// middle of that write leaves the other slot intact; reopening takes the
+// newest slot whose checksum matches.
+//
+// A slot holds the front index f and the end index e (both counting up and
+// masked on access, as in SpscQueue), the end index 'synced' as of the last
+// write-back, and a hash chain over the cells pushed since then. Between
+// write-backs the kernel may write the header page before the cells, so
+// after a power loss a slot can point past cells that never reached the
+// disk. Reopening rehashes the cells in [synced, e) and falls back to
+// 'synced' when they do not match, so a crash can lose the last pushes but
+// never exposes a cell that was not written. For the same reason a push
+// never overwrites a cell that the last write-back still lists as queued:
+// when it would, it writes back first.
+//
+// Durability is batched: every 'syncEvery' pushes or pops the dirty part of
+// the mapping is written back with msync(MS_SYNC). syncEvery = 1 makes every
+// operation durable before it returns; 0 leaves write-back to the kernel
+// (data survives a process crash, but not a power loss). sync() forces one.
+//
+// A file whose capacity or element size differ from the ones asked for, or
+// whose slots are both damaged, makes the constructor throw.
+template <class T>
+class PersistentQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "PersistentQueue stores raw bytes of T");
+
+public:
+    struct Slot {
+        uint64_t seq;
+        uint64_t f, e;
+        uint64_t synced;        // End index as of the last write-back
+        uint64_t syncedHash;    // Hash chain up to 'synced'
+        uint64_t tailHash;      // Hash chain up to e
+        uint64_t checksum;
+    };
+
+    struct Header {
+        uint64_t magic;
+        uint64_t cap;
+        uint64_t elemSize;
+        Slot slot[2];
+    };
+
+    int fd;
+    size_t bytes;        // Size of the mapping
+    Header* h;
+    T* a;
+    size_t cap;
+    size_t syncEvery;
+    size_t unsynced;     // Operations since the last write-back
+    Slot cur;            // Current state; written to h->slot[cur.seq & 1]
+    uint64_t syncedFront;   // f as of the last write-back
+
+    PersistentQueue(const std::string& path, size_t capacity, size_t syncInterval = 0)
+        : fd(-1), bytes(0), h(nullptr), a(nullptr), cap(1), syncEvery(syncInterval), unsynced(0),
+          cur(), syncedFront(0) {
+        while (cap < capacity) cap *= 2;
+        bytes = pageAlign(sizeof(Header)) + cap * sizeof(T);
+
+        fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) throw std::runtime_error("cannot open " + path + ": " + strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0) fail("cannot stat " + path + ": " + strerror(errno));
+        bool fresh = (st.st_size == 0);
+        if (fresh && ftruncate(fd, bytes) != 0) fail("cannot size " + path + ": " + strerror(errno));
+        if (!fresh && (size_t)st.st_size != bytes) fail(path + " has the wrong size for this queue");
+
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) fail("cannot map " + path + ": " + strerror(errno));
+        h = (Header*)p;
+        a = (T*)((char*)p + pageAlign(sizeof(Header)));
+
+        if (fresh || h->magic == 0) {           // New, or created by a process that died
+            memset(h, 0, sizeof(Header));
+            h->cap = cap;
+            h->elemSize = sizeof(T);
+            cur.syncedHash = cur.tailHash = PQUEUE_FNV_SEED;
+            publish();
+            msync(h, sizeof(Header), MS_SYNC);
+            h->magic = PQUEUE_MAGIC;            // Only once the slot is on disk
+            msync(h, sizeof(Header), MS_SYNC);
+        } else if (h->magic != PQUEUE_MAGIC || h->cap != cap || h->elemSize != sizeof(T)) {
+            fail(path + " holds a different queue");
+        } else if (!recover()) {
+            fail(path + " is corrupt");
+        }
+        syncedFront = cur.f;
+    }
+
+    PersistentQueue(const PersistentQueue&) = delete;
+    PersistentQueue& operator=(const PersistentQueue&) = delete;
+
+    ~PersistentQueue() {
+        if (h) {
+            sync();
+            munmap(h, bytes);
+        }
+        if (fd >= 0) close(fd);
+    }
+
+    bool empty() const {
+        return cur.e == cur.f;
+    }
+
+    size_t size() const {
+        return cur.e - cur.f;
+    }
+
+    size_t capacity() const {
+        return cap;
+    }
+
+    T& front() {
+        return a[cur.f & (cap - 1)];
+    }
+
+    // Insert x unless the queue is full
+    bool push(const T& x) {
+        if (size() == cap) return false;
+        if (cur.e - syncedFront == cap) sync();     // The cell is still queued on disk
+        T* cell = &a[cur.e & (cap - 1)];
+        *cell = x;
+        cur.tailHash = hashBytes(cur.tailHash, cell, sizeof(T));
+        ++ cur.e;
+        publish();
+        operation();
+        return true;
+    }
+
+    // Pop the front element
+    void pop() {
+        if (empty()) return;
+        ++ cur.f;
+        publish();
+        operation();
+    }
+
+    // Write back every cell pushed since the last write-back, then the header
+    void sync() {
+        for (uint64_t i = cur.synced; i < cur.e; ) {
+            size_t cell = i & (cap - 1);
+            size_t n = std::min<uint64_t>(cur.e - i, cap - cell);   // Up to the end of the buffer
+            syncRange(a + cell, n * sizeof(T));
+            i += n;
+        }
+        cur.synced = cur.e;
+        cur.syncedHash = cur.tailHash;
+        publish();
+        msync(h, sizeof(Header), MS_SYNC);
+        syncedFront = cur.f;
+        unsynced = 0;
+    }
+
+    void operation() {
+        if (syncEvery && ++ unsynced >= syncEvery) sync();
+    }
+
+    // Store the current state in the older slot
+    void publish() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);   // Cells and the other slot first
+        ++ cur.seq;
+        cur.checksum = checksum(cur);
+        h->slot[cur.seq & 1] = cur;
+    }
+
+    // Load the newest valid slot and drop pushes whose cells did not reach the
+    // file; false if neither slot is valid
+    bool recover() {
+        const Slot* best = nullptr;
+        for (const Slot& s : h->slot) {
+            bool valid = s.checksum == checksum(s) && s.f <= s.e && s.e - s.f <= cap &&
+                         s.synced <= s.e && s.e - s.synced <= cap;
+            if (valid && (!best || s.seq > best->seq)) best = &s;
+        }
+        if (!best) return false;
+        cur = *best;
+
+        uint64_t x = cur.syncedHash;
+        for (uint64_t i = cur.synced; i < cur.e; ++ i) x = hashBytes(x, &a[i & (cap - 1)], sizeof(T));
+        if (x != cur.tailHash) {
+            cur.e = std::max(cur.synced, cur.f);
+            cur.tailHash = PQUEUE_FNV_SEED;
+            cur.synced = cur.e;                 // Nothing left to check
+            cur.syncedHash = cur.tailHash;
+        }
+        sync();     // Cells that only reached the page cache are made durable
+        return true;
+    }
+
+    // msync the pages covering [p, p + n)
+    static void syncRange(void* p, size_t n) {
+        size_t page = sysconf(_SC_PAGESIZE);
+        uintptr_t start = (uintptr_t)p & ~(page - 1);
+        msync((void*)start, (uintptr_t)p + n - start, MS_SYNC);
+    }
+
+    static size_t pageAlign(size_t n) {
+        size_t page = sysconf(_SC_PAGESIZE);
+        return (n + page - 1) / page * page;
+    }
+
+    // FNV-1a over n bytes, continuing from x
+    static uint64_t hashBytes(uint64_t x, const void* p, size_t n) {
+        const unsigned char* c = (const unsigned char*)p;
+        for (size_t i = 0; i < n; ++ i) {
+            x ^= c[i];
+            x *= 1099511628211ULL;
+        }
+        return x;
+    }
+
+    static uint64_t checksum(const Slot& s) {
+        const uint64_t fields[] = {s.seq, s.f, s.e, s.synced, s.syncedHash, s.tailHash};
+        return hashBytes(PQUEUE_FNV_SEED, fields, sizeof(fields));
+    }
+
+    void fail(const std::string& why) {
+        if (h) munmap(h, bytes);
+        h = nullptr;
+        close(fd);
+        fd = -1;
+        throw std::runtime_error(why);
+    }
+
+};
+
+#endif
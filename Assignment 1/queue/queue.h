@@ -0,0 +1,255 @@
+#ifndef __Queue_H
+#define __Queue_H
+
+#include <iostream>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+
+// Initial (and smallest) capacity of a Queue; must be a power of two
+#define QUEUE_MIN_CAPACITY 16
+
+// Size of a cache line, to keep data written by different threads apart
+#define CACHE_LINE 64
+
+// Move n elements from 'from' to the uninitialized memory at 'to', and
+// destroy the originals. Trivially copyable elements are copied in bulk.
+template <class T>
+inline void relocate(T* from, size_t n, T* to) {
+    if (std::is_trivially_copyable<T>::value) {
+        if (n) memcpy((void*)to, (const void*)from, n * sizeof(T));
+        return;
+    }
+    for (size_t i = 0; i < n; ++ i) {
+        new (to + i) T(std::move(from[i]));
+        from[i].~T();
+    }
+}
+
+// Copy n elements from 'from' to the uninitialized memory at 'to'
+template <class T>
+inline void copyConstruct(const T* from, size_t n, T* to) {
+    if (std::is_trivially_copyable<T>::value) {
+        if (n) memcpy((void*)to, (const void*)from, n * sizeof(T));
+        return;
+    }
+    for (size_t i = 0; i < n; ++ i) new (to + i) T(from[i]);
+}
+
+// Move n elements from 'from' over the existing elements at 'to', and
+// destroy the originals
+template <class T>
+inline void moveAssign(T* from, size_t n, T* to) {
+    if (std::is_trivially_copyable<T>::value) {
+        if (n) memcpy((void*)to, (const void*)from, n * sizeof(T));
+        return;
+    }
+    for (size_t i = 0; i < n; ++ i) {
+        to[i] = std::move(from[i]);
+        from[i].~T();
+    }
+}
+
+// A contiguous run of elements
+template <class T>
+struct Span {
+    T* data;
+    size_t size;
+};
+
+// Statistics policy of an uninstrumented Queue: every hook is empty, and
+// as an empty base class it takes no space. See queue_stats.h for the
+// instrumented one.
+struct NoQueueStats {
+    void pushed(size_t, size_t) {}
+    void popped(size_t) {}
+    void cleared(size_t) {}
+    void rejected() {}
+};
+
+// Circular queue. The elements are a[f], a[f + 1], ... a[e - 1], wrapping
+// around at 'cap'. The capacity is always a power of two, so wrapping is a
+// mask with cap - 1 instead of a modulo. A full queue grows to twice its
+// capacity, and with 'shrink' set a queue a quarter full halves it.
+//
+// Stats is told about every push (count pushed, new size), every pop
+// (count popped) and every clear() (count dropped unconsumed); bounded
+// queues built on Queue report refused pushes through rejected().
+template <class T, class Stats = NoQueueStats>
+class Queue : public Stats {
+public:
+    size_t cap, sz, f, e;
+    T* a;
+    bool shrink;
+
+    Queue(size_t capacity = QUEUE_MIN_CAPACITY, bool shrinkWhenSparse = false)
+        : cap(QUEUE_MIN_CAPACITY), sz(0), f(0), e(0), a(nullptr), shrink(shrinkWhenSparse) {
+        while (cap < capacity) cap *= 2;
+        a = allocate(cap);
+    }
+
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
+
+    Queue(Queue&& src) : Stats(std::move(src)), cap(src.cap), sz(src.sz), f(src.f), e(src.e), a(src.a), shrink(src.shrink) {
+        src.a = allocate(QUEUE_MIN_CAPACITY);
+        src.cap = QUEUE_MIN_CAPACITY;
+        src.sz = src.f = src.e = 0;
+    }
+
+    ~Queue() {
+        clear();
+        ::operator delete(a);
+    }
+
+    // Check if the queue is empty
+    bool empty() const {
+        return (sz == 0);
+    }
+
+    // Return the size of queue
+    size_t size() const {
+        return sz;
+    }
+
+    // Return the number of elements the queue can hold before growing
+    size_t capacity() const {
+        return cap;
+    }
+
+    // Return the element at the front of the queue
+    T& front() {
+        return a[f];
+    }
+
+    // Return the element at the back of the queue
+    T& back() {
+        return a[(e - 1) & (cap - 1)];
+    }
+
+    // Construct an element at the back of the queue
+    template <class... Args>
+    void emplace(Args&&... args) {
+        if (sz == cap) {
+            T x(std::forward<Args>(args)...);  // args may refer to the buffer being replaced
+            resize(2 * cap);
+            new (a + e) T(std::move(x));
+        } else new (a + e) T(std::forward<Args>(args)...);
+        e = (e + 1) & (cap - 1);
+        ++ sz;
+        Stats::pushed(1, sz);
+    }
+
+    // Insert an element to the queue
+    void push(const T& x) {
+        emplace(x);
+    }
+
+    void push(T&& x) {
+        emplace(std::move(x));
+    }
+
+    // Pop an element out of the queue
+    void pop() {
+        if (empty()) return; // Return if the queue is empty
+        Stats::popped(1);
+        a[f].~T();
+        f = (f + 1) & (cap - 1);
+        -- sz;
+        if (shrink && cap > QUEUE_MIN_CAPACITY && sz <= cap / 4) resize(cap / 2);
+    }
+
+    // Insert the n elements p[0 .. n) at the back, growing at most once.
+    // They are copied as at most two contiguous segments: up to the end of
+    // the buffer, then from its start. p must not point into the queue.
+    void push_n(const T* p, size_t n) {
+        if (sz + n > cap) {
+            size_t c = cap;
+            while (c < sz + n) c *= 2;
+            resize(c);
+        }
+        size_t first = std::min(n, cap - e);
+        copyConstruct(p, first, a + e);
+        copyConstruct(p + first, n - first, a);
+        e = (e + n) & (cap - 1);
+        sz += n;
+        Stats::pushed(n, sz);
+    }
+
+    // Move up to n elements from the front to out[0 ..), as at most two
+    // contiguous segments. Returns the number of elements popped.
+    size_t pop_n(T* out, size_t n) {
+        n = std::min(n, sz);
+        Stats::popped(n);
+        size_t first = std::min(n, cap - f);
+        moveAssign(a + f, first, out);
+        moveAssign(a, n - first, out + first);
+        f = (f + n) & (cap - 1);
+        sz -= n;
+        if (shrink && cap > QUEUE_MIN_CAPACITY && sz <= cap / 4) {
+            size_t c = cap;
+            while (c > QUEUE_MIN_CAPACITY && sz <= c / 4) c /= 2;
+            resize(c);
+        }
+        return n;
+    }
+
+    // The elements, front first, as two spans without copying; the second
+    // one is empty unless the elements wrap around the end of the buffer.
+    // They stay valid until the queue is modified.
+    std::pair<Span<T>, Span<T>> peek_segments() {
+        size_t first = std::min(sz, cap - f);
+        return std::make_pair(Span<T>{a + f, first}, Span<T>{a, sz - first});
+    }
+
+    // Remove n elements from the front, e.g. after reading them through
+    // peek_segments()
+    void consume(size_t n) {
+        n = std::min(n, sz);
+        Stats::popped(n);
+        for (size_t i = 0; i < n; ++ i) a[(f + i) & (cap - 1)].~T();
+        f = (f + n) & (cap - 1);
+        sz -= n;
+    }
+
+    // Remove every element; the capacity is kept
+    void clear() {
+        if (sz) Stats::cleared(sz);
+        while (sz) {
+            a[f].~T();
+            f = (f + 1) & (cap - 1);
+            -- sz;
+        }
+        f = e = 0;
+    }
+
+    void print() const {
+        for (size_t i = 0; i < sz; ++ i) std::cout << a[(f + i) & (cap - 1)] << " ";
+        std::cout << "\n";
+    }
+
+    static T* allocate(size_t n) {
+        return (T*)::operator new(n * sizeof(T));
+    }
+
+    // Move the elements to a buffer of 'n' cells (n >= sz, a power of two).
+    // The two segments of the ring, [f, cap) and [0, e), are moved in bulk
+    // and end up unwrapped at the start of the new buffer.
+    void resize(size_t n) {
+        T* b = allocate(n);
+        size_t first = (f + sz <= cap) ? sz : cap - f;
+        relocate(a + f, first, b);
+        relocate(a, sz - first, b + first);
+        ::operator delete(a);
+        a = b;
+        cap = n;
+        f = 0;
+        e = sz & (cap - 1);
+    }
+
+};
+
+#endif
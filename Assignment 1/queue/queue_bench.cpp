@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <queue>
+#include <vector>
+#include <algorithm>
+
+#include "../bench.h"
+#include "queue.h"
+#include "bench_queues.h"
+
+// Check Queue against std::queue with random pushes and pops, on a type
+// that owns memory, with and without shrinking
+bool check_queue(bool shrink) {
+    Queue<std::string> q(QUEUE_MIN_CAPACITY, shrink);
+    std::queue<std::string> ref;
+    srand(1);
+    for (int i = 0; i < 200000; ++ i) {
+        // Grow and drain in waves so the capacity moves both ways
+        bool grow = (i / 20000) % 2 == 0;
+        if (rand() % 100 < (grow ? 70 : 30)) {
+            std::string s = std::to_string(i);
+            q.push(s);
+            ref.push(s);
+        } else if (!ref.empty()) {
+            if (q.front() != ref.front()) return false;
+            q.pop();
+            ref.pop();
+        }
+        if (q.size() != ref.size() || (!ref.empty() && q.back() != ref.back())) return false;
+    }
+    if (shrink && q.capacity() > 4 * QUEUE_MIN_CAPACITY && q.size() < q.capacity() / 8) return false;
+    return true;
+}
+
+// Check push_n, pop_n and peek_segments against single pushes and pops,
+// with batches that wrap around the end of the buffer
+bool check_batches() {
+    Queue<std::string> q;
+    std::queue<std::string> ref;
+    std::vector<std::string> in, out(64);
+    srand(2);
+    for (int i = 0; i < 20000; ++ i) {
+        size_t n = rand() % 40;
+        if (rand() % 2) {
+            in.clear();
+            for (size_t j = 0; j < n; ++ j) in.push_back(std::to_string(i * 100 + j));
+            q.push_n(in.data(), n);
+            for (const std::string& s : in) ref.push(s);
+        } else {
+            auto segs = q.peek_segments();
+            if (segs.first.size + segs.second.size != ref.size()) return false;
+            if (segs.first.size && segs.first.data[0] != ref.front()) return false;
+            size_t got = q.pop_n(out.data(), n);
+            if (got != std::min(n, ref.size())) return false;
+            for (size_t j = 0; j < got; ++ j) {
+                if (out[j] != ref.front()) return false;
+                ref.pop();
+            }
+        }
+    }
+    return q.size() == ref.size();
+}
+
+// Move 'ops' ints through a queue holding about 'depth' of them, 'batch'
+// at a time, with push_n/pop_n or with single pushes and pops
+long batched(long ops, size_t batch, bool bulk) {
+    Queue<int> q;
+    std::vector<int> buf(batch);
+    for (size_t i = 0; i < batch; ++ i) buf[i] = (int)i;
+    for (int i = 0; i < 1000; ++ i) q.push(i);
+    long sum = 0;
+    for (long done = 0; done < ops; done += 2 * batch) {
+        if (bulk) {
+            q.push_n(buf.data(), batch);
+            q.pop_n(buf.data(), batch);
+        } else {
+            for (size_t i = 0; i < batch; ++ i) q.push(buf[i]);
+            for (size_t i = 0; i < batch; ++ i) {
+                buf[i] = q.front();
+                q.pop();
+            }
+        }
+        sum += buf[0];
+    }
+    return sum;
+}
+
+// Push and pop 'ops' times in total with about 'depth' elements queued
+template <class Q>
+long steady(long ops, int depth) {
+    Q q;
+    long sum = 0;
+    for (int i = 0; i < depth; ++ i) q.push(i);
+    for (long i = 0; i < ops / 2; ++ i) {
+        q.push((int)i);
+        sum += q.front();
+        q.pop();
+    }
+    return sum;
+}
+
+// Push ops/2 elements, then pop them all
+template <class Q>
+long fill_drain(long ops) {
+    Q q;
+    long sum = 0;
+    for (long i = 0; i < ops / 2; ++ i) q.push((int)i);
+    while (!q.empty()) {
+        sum += q.front();
+        q.pop();
+    }
+    return sum;
+}
+
+// Best of 3 runs of f, in ns per operation
+template <class F>
+double ns_per_op(F f, long ops) {
+    double best = 0;
+    for (int r = 0; r < 3; ++ r) {
+        auto start = std::chrono::steady_clock ::now();
+        doNotOptimize(f());
+        auto stop = std::chrono::steady_clock ::now();
+        double ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / ops;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+// Usage: queue_bench [operations]
+// Compares Queue<int> with std::queue<int> and std::deque<int> on 1e8
+// operations by default
+int main(int argc, char* argv[]) {
+
+    if (!check_queue(false) || !check_queue(true) || !check_batches()) {
+        std::cerr << "Queue disagrees with std::queue\n";
+        return 1;
+    }
+
+    long ops = argc > 1 ? atol(argv[1]) : 100000000;
+    std::cout << "pattern\t\tQueue (ns/op)\tstd::queue (ns/op)\tstd::deque (ns/op)\n";
+    for (int depth : {16, 1000, 100000}) {
+        std::cout << "steady " << depth << "\t" << ns_per_op([&]() { return steady<Queue<int>>(ops, depth); }, ops)
+                  << "\t" << ns_per_op([&]() { return steady<std::queue<int>>(ops, depth); }, ops)
+                  << "\t" << ns_per_op([&]() { return steady<DequeQueue>(ops, depth); }, ops) << "\n";
+    }
+    std::cout << "fill/drain\t" << ns_per_op([&]() { return fill_drain<Queue<int>>(ops); }, ops)
+              << "\t" << ns_per_op([&]() { return fill_drain<std::queue<int>>(ops); }, ops)
+              << "\t" << ns_per_op([&]() { return fill_drain<DequeQueue>(ops); }, ops) << "\n";
+
+    std::cout << "batch\tpush_n/pop_n (ns/element)\tpush/pop (ns/element)\n";
+    for (size_t batch : {1, 16, 256, 4096}) {
+        std::cout << batch << "\t" << ns_per_op([&]() { return batched(ops, batch, true); }, ops)
+                  << "\t" << ns_per_op([&]() { return batched(ops, batch, false); }, ops) << "\n";
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,131 @@
+#ifndef __QueueStats_H
+#define __QueueStats_H
+
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+
+#include "queue.h"
+
+// Number of residence time buckets; bucket b counts times in [2^(b-1), 2^b) ns
+#define QUEUE_STATS_BUCKETS 48
+
+// Statistics of a queue at one point in time
+struct QueueStatsSnapshot {
+    uint64_t pushes, pops, drops, rejects;  // drops: removed by clear(), not popped
+    size_t highWater;                       // Largest size reached
+    uint64_t residence[QUEUE_STATS_BUCKETS]; // Histogram of time spent queued
+
+    // Upper bound, in ns, of the time spent queued by the fraction q of the
+    // popped elements (e.g. q = 0.99 for p99)
+    double residencePercentile(double q) const {
+        uint64_t total = 0, seen = 0;
+        for (uint64_t c : residence) total += c;
+        for (int b = 0; b < QUEUE_STATS_BUCKETS; ++ b) {
+            seen += residence[b];
+            if (total && seen >= q * total) return (double)(1ULL << b);
+        }
+        return 0;
+    }
+
+    void print(std::ostream& out) const {
+        out << "pushes " << pushes << ", pops " << pops << ", dropped " << drops << ", rejected " << rejects
+            << ", high water " << highWater << ", residence p50 < " << residencePercentile(0.5)
+            << " ns, p99 < " << residencePercentile(0.99) << " ns\n";
+    }
+
+    void printJson(std::ostream& out) const {
+        out << "{\"pushes\": " << pushes << ", \"pops\": " << pops << ", \"dropped\": " << drops
+            << ", \"rejected\": " << rejects << ", \"high_water\": " << highWater << ", \"residence_ns_log2\": [";
+        int last = QUEUE_STATS_BUCKETS;
+        while (last > 0 && residence[last - 1] == 0) -- last;
+        for (int b = 0; b < last; ++ b) out << (b ? ", " : "") << residence[b];
+        out << "]}\n";
+    }
+};
+
+// Statistics policy for Queue: Queue<T, QueueStats> counts pushes, pops,
+// elements dropped by clear() and rejected pushes, tracks the high-water
+// mark, and times how long every popped element stayed queued. Since a
+// queue is FIFO, the push times are kept in a queue of their own and the
+// front one always belongs to the element being popped.
+//
+// Timing costs two clock reads per element, so this is for diagnostic
+// builds; Queue<T> (with NoQueueStats) compiles every hook away.
+class QueueStats {
+public:
+    uint64_t pushes, pops, drops, rejects;
+    size_t highWater;
+    uint64_t residence[QUEUE_STATS_BUCKETS];
+    Queue<uint64_t> stamps;   // Push time of every queued element, in ns
+
+    QueueStats() {
+        reset();
+    }
+
+    void pushed(size_t n, size_t size) {
+        pushes += n;
+        highWater = std::max(highWater, size);
+        uint64_t t = now();
+        for (size_t i = 0; i < n; ++ i) stamps.push(t);
+    }
+
+    void popped(size_t n) {
+        pops += n;
+        uint64_t t = now();
+        for (size_t i = 0; i < n && !stamps.empty(); ++ i) {
+            ++ residence[bucket(t - stamps.front())];
+            stamps.pop();
+        }
+    }
+
+    // Dropped elements were never consumed, so they are not timed
+    void cleared(size_t n) {
+        drops += n;
+        for (size_t i = 0; i < n && !stamps.empty(); ++ i) stamps.pop();
+    }
+
+    void rejected() {
+        ++ rejects;
+    }
+
+    // Copy of the counters; the queue keeps counting
+    QueueStatsSnapshot snapshot() const {
+        QueueStatsSnapshot s;
+        s.pushes = pushes;
+        s.pops = pops;
+        s.drops = drops;
+        s.rejects = rejects;
+        s.highWater = highWater;
+        std::copy(residence, residence + QUEUE_STATS_BUCKETS, s.residence);
+        return s;
+    }
+
+    // Zero the counters; elements already queued are still timed
+    void reset() {
+        pushes = pops = drops = rejects = 0;
+        highWater = 0;
+        std::fill(residence, residence + QUEUE_STATS_BUCKETS, 0);
+    }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Number of significant bits of ns, capped to the last bucket
+    static int bucket(uint64_t ns) {
+#if defined(__GNUC__)
+        int b = ns ? 64 - __builtin_clzll(ns) : 0;
+#else
+        int b = 0;
+        for (uint64_t x = ns; x; x >>= 1) ++ b;
+#endif
+        return std::min(b, QUEUE_STATS_BUCKETS - 1);
+    }
+
+};
+
+#endif
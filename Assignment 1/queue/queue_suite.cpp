@@ -0,0 +1,177 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <queue>
+#include <vector>
+#include <thread>
+
+#include "../bench.h"
+#include "queue.h"
+#include "spsc_queue.h"
+#include "mpmc_queue.h"
+#include "blocking_queue.h"
+#include "bench_queues.h"
+
+// Queue benchmark suite
+// ---------------------
+//
+// Single-threaded patterns, each run on Queue<int>, std::queue<int> and
+// std::deque<int> through runBench():
+//
+//   steady N     one push and one pop with about N elements queued
+//   burst N      push N elements, then pop all of them
+//   wrap         push 32 and pop 32 on a ring of 64 holding 16, so every
+//                other batch crosses the end of the buffer
+//
+// Multi-threaded handoff, P producers passing items to P consumers through
+// SpscQueue (P = 1 only), MpmcQueue, BlockingQueue and a Queue under a
+// mutex. Each sample passes 'items' items and there are 100 samples, so
+// p99 is the second slowest sample rather than the slowest.
+//
+// Every result is in ns per element operation (a push or a pop), so the
+// columns can be compared across patterns; a handoff item is one push and
+// one pop, so it counts as two operations.
+
+// Turn ns per call into ns per element operation
+BenchResult per_op(BenchResult r, double ops) {
+    r.min /= ops;
+    r.median /= ops;
+    r.p99 /= ops;
+    r.mean /= ops;
+    r.stddev /= ops;
+    return r;
+}
+
+template <class Q>
+BenchResult steady(const std::string& name, int depth) {
+    Q q;
+    for (int i = 0; i < depth; ++ i) q.push(i);
+    int i = 0;
+    return per_op(runBench(name, [&]() {
+        q.push(++ i);
+        doNotOptimize(q.front());
+        q.pop();
+    }), 2);
+}
+
+template <class Q>
+BenchResult burst(const std::string& name, int n) {
+    Q q;
+    return per_op(runBench(name, [&]() {
+        for (int i = 0; i < n; ++ i) q.push(i);
+        long sum = 0;
+        while (!q.empty()) {
+            sum += q.front();
+            q.pop();
+        }
+        doNotOptimize(sum);
+    }), 2.0 * n);
+}
+
+template <class Q>
+BenchResult wrap(const std::string& name) {
+    Q q;
+    for (int i = 0; i < 16; ++ i) q.push(i);
+    return per_op(runBench(name, [&]() {
+        for (int i = 0; i < 32; ++ i) q.push(i);
+        long sum = 0;
+        for (int i = 0; i < 32; ++ i) {
+            sum += q.front();
+            q.pop();
+        }
+        doNotOptimize(sum);
+    }), 64);
+}
+
+template <class Q>
+inline void put(Q& q, long x) {
+    for (int spins = 0; !q.try_push(x); ) backoff(spins);
+}
+
+template <class Q>
+inline long take(Q& q) {
+    long x;
+    for (int spins = 0; !q.try_pop(x); ) backoff(spins);
+    return x;
+}
+
+inline void put(BlockingQueue<long>& q, long x) {
+    q.push_wait(x);
+}
+
+inline long take(BlockingQueue<long>& q) {
+    long x = 0;
+    q.pop_wait(x);
+    return x;
+}
+
+// Pass 'items' items from 'pairs' producers to 'pairs' consumers, 'reps'
+// times; each sample is ns per element operation, half the time per item
+template <class Q>
+BenchResult handoff(const std::string& name, int pairs, long items, int reps) {
+    std::vector<double> samples;
+    long each = items / pairs;
+    for (int r = 0; r < reps; ++ r) {
+        Q q(1024);
+        std::vector<std::thread> threads;
+        std::vector<long> sums(pairs);
+        auto start = std::chrono::steady_clock ::now();
+        for (int t = 0; t < pairs; ++ t) {
+            threads.emplace_back([&q, each]() {
+                for (long i = 0; i < each; ++ i) put(q, i);
+            });
+            threads.emplace_back([&q, &sums, t, each]() {
+                long sum = 0;
+                for (long i = 0; i < each; ++ i) sum += take(q);
+                sums[t] = sum;
+            });
+        }
+        for (std::thread& th : threads) th.join();
+        auto stop = std::chrono::steady_clock ::now();
+        long total = 0;
+        for (long s : sums) total += s;
+        if (total != pairs * (each * (each - 1) / 2)) std::cerr << name << ": lost items!\n";
+        samples.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / (2.0 * each * pairs));
+    }
+    return summarize(name, each * pairs, samples);
+}
+
+// Usage: queue_suite [table|csv|json] [handoff items per sample]
+int main(int argc, char* argv[]) {
+
+    std::string format = argc > 1 ? argv[1] : "table";
+    long items = argc > 2 ? atol(argv[2]) : 100000;
+    const int handoffReps = 100;
+    std::vector<BenchResult> results;
+
+    for (int depth : {16, 1000, 100000}) {
+        std::string d = std::to_string(depth);
+        results.push_back(steady<Queue<int>>("steady " + d + " Queue", depth));
+        results.push_back(steady<std::queue<int>>("steady " + d + " std::queue", depth));
+        results.push_back(steady<DequeQueue>("steady " + d + " std::deque", depth));
+    }
+    for (int n : {64, 4096, 1 << 20}) {
+        std::string b = std::to_string(n);
+        results.push_back(burst<Queue<int>>("burst " + b + " Queue", n));
+        results.push_back(burst<std::queue<int>>("burst " + b + " std::queue", n));
+        results.push_back(burst<DequeQueue>("burst " + b + " std::deque", n));
+    }
+    results.push_back(wrap<Queue<int>>("wrap Queue"));
+    results.push_back(wrap<std::queue<int>>("wrap std::queue"));
+    results.push_back(wrap<DequeQueue>("wrap std::deque"));
+
+    if (std::thread::hardware_concurrency() < 2) std::cerr << "Only one core: handoff threads share it\n";
+    results.push_back(handoff<SpscQueue<long>>("handoff 1x1 SpscQueue", 1, items, handoffReps));
+    for (int pairs : {1, 2}) {
+        std::string p = std::to_string(pairs) + "x" + std::to_string(pairs);
+        results.push_back(handoff<MpmcQueue<long>>("handoff " + p + " MpmcQueue", pairs, items, handoffReps));
+        results.push_back(handoff<BlockingQueue<long>>("handoff " + p + " BlockingQueue", pairs, items, handoffReps));
+        results.push_back(handoff<MutexQueue>("handoff " + p + " mutex Queue", pairs, items, handoffReps));
+    }
+
+    printResults(std::cout, results, format);
+
+    return 0;
+
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+
+#include "queue.h"
+#include "spsc_queue.h"
+#include "bench_queues.h"
+
+// Pin the calling thread to 'core' (modulo the number of cores)
+void pin(int core) {
+    int cores = std::thread::hardware_concurrency();
+    if (cores <= 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Pass n items from a producer on core 0 to a consumer on core 1; returns
+// operations (items) per second, or -1 if an item was lost or duplicated
+template <class Q>
+double throughput(long n) {
+    Q q(1024);
+    long sum = 0;
+    auto start = std::chrono::steady_clock ::now();
+    std::thread consumer([&]() {
+        pin(1);
+        long x;
+        int spins = 0;
+        for (long i = 0; i < n; ++ i) {
+            while (!q.try_pop(x)) backoff(spins);
+            sum += x;
+        }
+    });
+    pin(0);
+    int spins = 0;
+    for (long i = 0; i < n; ++ i) {
+        while (!q.try_push(i)) backoff(spins);
+    }
+    consumer.join();
+    auto stop = std::chrono::steady_clock ::now();
+    if (sum != n * (n - 1) / 2) return -1;
+    return n / std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+}
+
+// Bounce a token between two threads through two queues n times; returns
+// the round-trip latencies in ns, sorted
+template <class Q>
+std::vector<double> round_trip(long n) {
+    Q ping(16), pong(16);
+    std::thread echo([&]() {
+        pin(1);
+        long x;
+        int spins = 0;
+        for (long i = 0; i < n; ++ i) {
+            while (!ping.try_pop(x)) backoff(spins);
+            while (!pong.try_push(x)) backoff(spins);
+        }
+    });
+    pin(0);
+    std::vector<double> ns;
+    long x;
+    int spins = 0;
+    for (long i = 0; i < n; ++ i) {
+        auto start = std::chrono::steady_clock ::now();
+        while (!ping.try_push(i)) backoff(spins);
+        while (!pong.try_pop(x)) backoff(spins);
+        auto stop = std::chrono::steady_clock ::now();
+        ns.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count());
+    }
+    echo.join();
+    std::sort(ns.begin(), ns.end());
+    return ns;
+}
+
+// Print the throughput and round-trip latency of Q; false if items were lost
+template <class Q>
+bool report(const char* name, long n, long trips) {
+    double ops = throughput<Q>(n);
+    if (ops < 0) {
+        std::cerr << name << ": items were lost\n";
+        return false;
+    }
+    std::vector<double> ns = round_trip<Q>(trips);
+    std::cout << name << "\t" << ops / 1e6 << " Mops/s\tround trip median " << ns[ns.size() / 2] << " ns, p99 "
+              << ns[ns.size() * 99 / 100] << " ns\n";
+    return true;
+}
+
+// Usage: spsc_bench [items]
+// Compares SpscQueue with a mutex-protected Queue between two pinned cores
+int main(int argc, char* argv[]) {
+
+    long n = argc > 1 ? atol(argv[1]) : 50000000;
+    if (std::thread::hardware_concurrency() < 2) std::cout << "Only one core: both threads share it\n";
+    if (!report<SpscQueue<long>>("SpscQueue", n, 100000)) return 1;
+    if (!report<MutexQueue>("mutex Queue", n, 100000)) return 1;
+
+    return 0;
+
+}
@@ -0,0 +1,93 @@
+#ifndef __SpscQueue_H
+#define __SpscQueue_H
+
+#include <cstddef>
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "queue.h"
+
+// Lock-free queue for exactly one producer thread and one consumer thread.
+//
+// Same layout as Queue: a power-of-two ring where the consumer owns the
+// front index f and the producer owns the end index e. Here f and e keep
+// counting up and are masked on access, so f == e means empty and
+// e - f == cap means full.
+//
+// Each index is published with a release store and read with an acquire
+// load, and lives on its own cache line next to the owner's copy of the
+// other index. The producer only re-reads f when its cached copy says the
+// queue is full, and the consumer only re-reads e when its copy says the
+// queue is empty, so the two cores rarely touch each other's line.
+template <class T>
+class SpscQueue {
+public:
+    // Consumer side
+    alignas(CACHE_LINE) std::atomic<size_t> f;
+    size_t cachedE;
+
+    // Producer side
+    alignas(CACHE_LINE) std::atomic<size_t> e;
+    size_t cachedF;
+
+    // Shared, read-only after construction
+    alignas(CACHE_LINE) size_t cap;
+    T* a;
+
+    SpscQueue(size_t capacity = 1024) : f(0), cachedE(0), e(0), cachedF(0), cap(1) {
+        while (cap < capacity) cap *= 2;
+        a = (T*)::operator new(cap * sizeof(T));
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() {
+        for (size_t i = f.load(); i != e.load(); ++ i) a[i & (cap - 1)].~T();
+        ::operator delete(a);
+    }
+
+    // Producer: insert x unless the queue is full
+    template <class U>
+    bool try_push(U&& x) {
+        size_t end = e.load(std::memory_order_relaxed);
+        if (end - cachedF == cap) {
+            cachedF = f.load(std::memory_order_acquire);
+            if (end - cachedF == cap) return false;
+        }
+        new (a + (end & (cap - 1))) T(std::forward<U>(x));
+        e.store(end + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: move the front element to x unless the queue is empty
+    bool try_pop(T& x) {
+        size_t front = f.load(std::memory_order_relaxed);
+        if (front == cachedE) {
+            cachedE = e.load(std::memory_order_acquire);
+            if (front == cachedE) return false;
+        }
+        T* p = a + (front & (cap - 1));
+        x = std::move(*p);
+        p->~T();
+        f.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Number of elements; only exact when neither side is running
+    size_t size() const {
+        return e.load(std::memory_order_acquire) - f.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return cap;
+    }
+
+};
+
+#endif
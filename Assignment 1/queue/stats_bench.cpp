@@ -0,0 +1,79 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "../bench.h"
+#include "queue.h"
+#include "queue_stats.h"
+#include "blocking_queue.h"
+
+// Check the counters of an instrumented Queue after a known sequence
+bool check_stats() {
+    Queue<int, QueueStats> q;
+    int in[10] = {0}, out[10];
+    for (int i = 0; i < 5; ++ i) q.push(i);
+    q.push_n(in, 10);
+    q.pop();
+    q.pop_n(out, 4);
+    q.consume(2);
+    q.clear();
+    QueueStatsSnapshot s = q.snapshot();
+    uint64_t timed = 0;
+    for (uint64_t c : s.residence) timed += c;
+    return s.pushes == 15 && s.pops == 7 && s.drops == 8 && s.highWater == 15 && timed == 7 && q.stamps.empty();
+}
+
+// Push and pop with about 'depth' elements queued, as in queue_suite
+template <class Q>
+BenchResult steady(const std::string& name, int depth) {
+    Q q;
+    for (int i = 0; i < depth; ++ i) q.push(i);
+    int i = 0;
+    return runBench(name, [&]() {
+        q.push(++ i);
+        doNotOptimize(q.front());
+        q.pop();
+    });
+}
+
+// Usage: stats_bench [table|csv|json]
+// Cost of QueueStats on push/pop, and the statistics of a producer that
+// outruns its consumer on a bounded BlockingQueue
+int main(int argc, char* argv[]) {
+
+    if (!check_stats()) {
+        std::cerr << "QueueStats counted wrong\n";
+        return 1;
+    }
+
+    std::cout << "sizeof(Queue<int>) = " << sizeof(Queue<int>) << ", sizeof(Queue<int, QueueStats>) = "
+              << sizeof(Queue<int, QueueStats>) << "\n";
+    std::vector<BenchResult> results;
+    results.push_back(steady<Queue<int>>("push+pop Queue", 1000));
+    results.push_back(steady<Queue<int, QueueStats>>("push+pop Queue with stats", 1000));
+    printResults(std::cout, results, argc > 1 ? argv[1] : "table");
+
+    // A producer that tries to push, and waits when the queue is full, onto
+    // a queue of 256 drained by a slower consumer
+    BlockingQueue<long, QueueStats> bq(256);
+    std::thread consumer([&]() {
+        long x;
+        while (bq.pop_wait(x)) {
+            if (x % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+    for (long i = 0; i < 100000; ++ i) {
+        if (!bq.try_push(i)) bq.push_wait(i);
+    }
+    bq.close();
+    consumer.join();
+    std::cout << "BlockingQueue: ";
+    QueueStatsSnapshot s = bq.snapshot();
+    if (argc > 1 && std::string(argv[1]) == "json") s.printJson(std::cout);
+    else s.print(std::cout);
+
+    return 0;
+
+}
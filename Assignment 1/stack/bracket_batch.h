@@ -0,0 +1,104 @@
+#ifndef __BracketBatch_H
+#define __BracketBatch_H
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "bracket_validator.h"
+
+// A record to validate: n bytes starting at p
+struct Record {
+    const char* p;
+    size_t n;
+};
+
+// Outcome for one record; 'error' is only meaningful when !valid
+struct BatchResult {
+    bool valid;
+    size_t error;
+};
+
+// Validates many short records on a fixed pool of threads. The threads are
+// started once and every call to validate() splits the records among them
+// in contiguous slices. Each thread keeps its own BracketValidator and only
+// resets it between records, so no Stack is built per record and its buffer
+// stops growing once it has seen the deepest record.
+class BatchValidator {
+public:
+    std::vector<std::thread> workers;
+    int threads;
+    std::mutex m;
+    std::condition_variable start, done;
+    long generation;                            // Incremented for every batch
+    int pending;                                // Workers still busy on the batch
+    bool stopping;
+    const std::vector<Record>* records;
+    std::vector<BatchResult>* results;
+
+    BatchValidator(int n = 0) : threads(n), generation(0), pending(0), stopping(false), records(nullptr), results(nullptr) {
+        if (threads <= 0) threads = std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+        for (int t = 0; t < threads; ++ t) workers.emplace_back(&BatchValidator::work, this, t);
+    }
+
+    BatchValidator(const BatchValidator&) = delete;
+    BatchValidator& operator=(const BatchValidator&) = delete;
+
+    ~BatchValidator() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        start.notify_all();
+        for (std::thread& th : workers) th.join();
+    }
+
+    // Number of threads in the pool
+    int size() const {
+        return threads;
+    }
+
+    // Validate every record of 'in'; out[i] receives the result of in[i]
+    void validate(const std::vector<Record>& in, std::vector<BatchResult>& out) {
+        out.resize(in.size());
+        std::unique_lock<std::mutex> lock(m);
+        records = &in;
+        results = &out;
+        pending = size();
+        ++ generation;
+        start.notify_all();
+        done.wait(lock, [this]() { return pending == 0; });
+    }
+
+    // Body of worker t: validate slice t of each batch
+    void work(int t) {
+        BracketValidator v;
+        long seen = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(m);
+            start.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            const std::vector<Record>& in = *records;
+            std::vector<BatchResult>& out = *results;
+            lock.unlock();
+
+            size_t begin = in.size() * t / size(), end = in.size() * (t + 1) / size();
+            for (size_t i = begin; i < end; ++ i) {
+                v.reset();
+                v.feed(in[i].p, in[i].n);
+                out[i].valid = v.finish();
+                out[i].error = v.errorOffset();
+            }
+
+            lock.lock();
+            if (-- pending == 0) done.notify_one();
+        }
+    }
+
+};
+
+#endif
@@ -0,0 +1,566 @@
+#ifndef __BracketDocument_H
+#define __BracketDocument_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "bracket_parallel.h"
+
+// Size of a document block; blocks are split at twice this size
+#define DOC_BLOCK_SIZE 1024
+
+// Blocks smaller than this are merged with a neighbour
+#define DOC_MIN_BLOCK (DOC_BLOCK_SIZE / 2)
+
+// Modulus of the bracket sequence hashes, 2^61 - 1
+#define DOC_HASH_MOD ((1ULL << 61) - 1)
+
+// Result of BracketDocument::status()
+struct DocumentStatus {
+    bool valid;
+    size_t error;   // Offset of the first mismatch, if not valid
+};
+
+// Summary of a stretch of text without the bracket sequences themselves.
+// Like a BracketSummary it stands for 'need' (the unmatched closers, as the
+// openers they want) and 'open' (the unmatched openers), but keeps only
+// their lengths and the hashes
+//
+//   needHash = sum need[j] * x^j        openHash = sum open[j] * x^-j
+//
+// modulo 2^61 - 1, and the powers of x for those lengths. A summary made by
+// composing A and B also records how: the number k of A's openers matched by
+// B's closers and the hashes around the cut, so that the hash of any prefix
+// of its sequences, or the offset of any closer in 'need', can be found by
+// walking down a single path of the tree.
+struct DocSummary {
+    size_t needLen, openLen;
+    size_t err;         // Offset of the first mismatch, or NO_BRACKET_ERROR
+    uint64_t needHash, openHash;
+    uint64_t needPow, needPowInv, openPow, openPowInv;  // x^needLen, x^-needLen, ...
+
+    // Composition of A and B
+    size_t aNeed;               // A's needLen
+    size_t aOpenKept;           // A's openers left unmatched by B
+    size_t k;                   // A's openers matched by B's closers
+    size_t shiftB;              // Bytes covered by A
+    uint64_t aNeedHash, aNeedPow;
+    uint64_t bNeedPreK;         // Hash of the first k closers of B
+    uint64_t negK;              // x^-k
+    uint64_t aOpenKeptHash;     // Hash of A's first aOpenKept openers
+    uint64_t negKept;           // x^-aOpenKept
+};
+
+// Incrementally validated text
+// ----------------------------
+//
+// The text is cut into blocks of DOC_MIN_BLOCK to 2 * DOC_BLOCK_SIZE bytes,
+// kept in order in a treap (a binary search tree balanced by random
+// priorities, ordered by position). Every node keeps the BracketSummary of
+// its own block, with prefix hashes of its sequences, and two DocSummary:
+// 'prefix' for its left subtree followed by its block, and 'all' for its
+// whole subtree, with offsets relative to the start of the subtree. The
+// root's 'all' describes the whole document.
+//
+// Composing two summaries matches the end of A's 'open' against the start of
+// B's 'need' by comparing two hashes, instead of walking the brackets; a
+// mismatch is then located by binary search. So a summary takes O(1) space
+// whatever the number of unmatched brackets, and composing costs O(log n)
+// hash lookups (O(log^2 n) when the texts mismatch).
+//
+// An edit that stays inside one block rescans that block only and
+// recomputes the summaries on the path to the root, O(DOC_BLOCK_SIZE +
+// log^2 n) in all. Larger edits split the treap at the edit positions and
+// cost O(log^2 n) per split or merge on top of the text copied. Blocks that
+// an edit leaves small are merged with a neighbour and empty ones removed,
+// so the treap has at most n / DOC_MIN_BLOCK + 1 nodes.
+//
+// Validity is decided by hash equality with a random x, so a document can
+// be reported valid when it is not with probability about n / 2^61.
+class BracketDocument {
+public:
+    enum Level { SELF, PREFIX, ALL };
+
+    struct DocNode {
+        std::string text;
+        BracketSummary self;
+        std::vector<uint64_t> needPre, openPre;   // Prefix hashes of self.need and self.open
+        DocSummary selfSum, prefix, all;
+        size_t len;           // Total bytes in this subtree
+        unsigned prio;
+        DocNode *left, *right;
+
+        DocNode(const std::string& t, unsigned p) : text(t), len(0), prio(p), left(nullptr), right(nullptr) {}
+    };
+
+    DocNode* root;
+    unsigned seed;
+    uint64_t x, xInv;       // Hash base and its inverse
+    DocSummary none;        // Summary of no text
+
+    BracketDocument() : root(nullptr), seed(2463534242u) {
+        std::random_device rd;
+        x = (((uint64_t)rd() << 32) ^ rd()) % (DOC_HASH_MOD - 2) + 2;
+        xInv = power(x, DOC_HASH_MOD - 2);
+        none = DocSummary();
+        none.err = NO_BRACKET_ERROR;
+        none.needPow = none.needPowInv = none.openPow = none.openPowInv = none.negK = none.negKept = 1;
+    }
+
+    BracketDocument(const BracketDocument&) = delete;
+    BracketDocument& operator=(const BracketDocument&) = delete;
+
+    ~BracketDocument() {
+        destroy(root);
+    }
+
+    // Number of bytes in the document
+    size_t size() const {
+        return len(root);
+    }
+
+    // Number of blocks the text is cut into
+    size_t blocks() const {
+        return count(root);
+    }
+
+    // Validity of the whole document and offset of its first mismatch
+    DocumentStatus status() const {
+        if (!root) return {true, 0};
+        const DocSummary& s = root->all;
+        size_t error = NO_BRACKET_ERROR;
+        if (s.needLen) error = std::min(needAt(root, ALL, 0), s.err);
+        else if (s.err != NO_BRACKET_ERROR) error = s.err;
+        else if (s.openLen) error = root->len;
+        return {error == NO_BRACKET_ERROR, error};
+    }
+
+    // Insert 'text' before byte 'pos'
+    void insert(size_t pos, const std::string& text) {
+        if (text.empty()) return;
+        if (pos > size()) pos = size();
+        if (root && insertInBlock(root, pos, text)) return;
+        DocNode *a, *b;
+        split(root, pos, a, b);
+        DocNode* m = nullptr;
+        for (size_t i = 0; i < text.size(); i += DOC_BLOCK_SIZE) m = merge(m, makeNode(text.substr(i, DOC_BLOCK_SIZE)));
+        root = merge(merge(a, m), b);
+        // The cut block and the last new block may be small
+        size_t end = pos + text.size();
+        if (pos > 0) compactAt(pos - 1);
+        compactAt(pos);
+        compactAt(end - 1);
+        if (end < size()) compactAt(end);
+    }
+
+    // Remove 'n' bytes starting at byte 'pos'
+    void erase(size_t pos, size_t n) {
+        if (pos >= size() || n == 0) return;
+        if (n > size() - pos) n = size() - pos;
+        size_t start;
+        if (eraseInBlock(root, pos, n, start)) {
+            if (start != NO_BRACKET_ERROR) compactAt(start);
+            return;
+        }
+        DocNode *a, *b, *c;
+        split(root, pos, a, b);
+        split(b, n, b, c);
+        destroy(b);
+        root = merge(a, c);
+        // Both sides of the cut may be small
+        if (pos > 0) compactAt(pos - 1);
+        if (pos < size()) compactAt(pos);
+    }
+
+    // The whole text, in order
+    std::string text() const {
+        std::string s;
+        s.reserve(size());
+        append(s, root);
+        return s;
+    }
+
+    static size_t len(const DocNode* t) {
+        return t ? t->len : 0;
+    }
+
+    static size_t count(const DocNode* t) {
+        return t ? 1 + count(t->left) + count(t->right) : 0;
+    }
+
+    unsigned random() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    // Hash arithmetic modulo 2^61 - 1
+
+    static uint64_t mul(uint64_t a, uint64_t b) {
+        unsigned __int128 p = (unsigned __int128)a * b;
+        uint64_t r = (uint64_t)(p & DOC_HASH_MOD) + (uint64_t)(p >> 61);
+        return r >= DOC_HASH_MOD ? r - DOC_HASH_MOD : r;
+    }
+
+    static uint64_t add(uint64_t a, uint64_t b) {
+        uint64_t r = a + b;
+        return r >= DOC_HASH_MOD ? r - DOC_HASH_MOD : r;
+    }
+
+    static uint64_t sub(uint64_t a, uint64_t b) {
+        return a >= b ? a - b : a + DOC_HASH_MOD - b;
+    }
+
+    static uint64_t power(uint64_t a, uint64_t e) {
+        uint64_t r = 1;
+        for (; e; e >>= 1, a = mul(a, a)) {
+            if (e & 1) r = mul(r, a);
+        }
+        return r;
+    }
+
+    // Summaries
+
+    // Summary 'level' of node t; a missing node covers no text
+    const DocSummary& view(const DocNode* t, int level) const {
+        if (!t) return none;
+        return level == SELF ? t->selfSum : level == PREFIX ? t->prefix : t->all;
+    }
+
+    // The two parts a composed summary is made of
+    static void parts(const DocNode* t, int level, const DocNode*& a, int& aLevel, const DocNode*& b, int& bLevel) {
+        if (level == ALL) {
+            a = t, aLevel = PREFIX;
+            b = t->right, bLevel = ALL;
+        } else {
+            a = t->left, aLevel = ALL;
+            b = t, bLevel = SELF;
+        }
+    }
+
+    // Hash of the first m closers in 'need' of summary (t, level)
+    uint64_t needPrefix(const DocNode* t, int level, size_t m) const {
+        uint64_t acc = 0, scale = 1;
+        while (m > 0) {
+            if (level == SELF) return add(acc, mul(scale, t->needPre[m]));
+            const DocSummary& s = view(t, level);
+            const DocNode *a, *b;
+            int aLevel, bLevel;
+            parts(t, level, a, aLevel, b, bLevel);
+            if (m <= s.aNeed) {
+                t = a, level = aLevel;
+                continue;
+            }
+            // A's closers, then B's from k on, shifted to follow them
+            uint64_t shift = mul(s.aNeedPow, s.negK);
+            acc = add(acc, mul(scale, sub(s.aNeedHash, mul(shift, s.bNeedPreK))));
+            scale = mul(scale, shift);
+            m = s.k + m - s.aNeed;
+            t = b, level = bLevel;
+        }
+        return acc;
+    }
+
+    // Hash of the first m openers in 'open' of summary (t, level)
+    uint64_t openPrefix(const DocNode* t, int level, size_t m) const {
+        uint64_t acc = 0, scale = 1;
+        while (m > 0) {
+            if (level == SELF) return add(acc, mul(scale, t->openPre[m]));
+            const DocSummary& s = view(t, level);
+            const DocNode *a, *b;
+            int aLevel, bLevel;
+            parts(t, level, a, aLevel, b, bLevel);
+            if (m <= s.aOpenKept) {
+                t = a, level = aLevel;
+                continue;
+            }
+            acc = add(acc, mul(scale, s.aOpenKeptHash));
+            scale = mul(scale, s.negKept);
+            m -= s.aOpenKept;
+            t = b, level = bLevel;
+        }
+        return acc;
+    }
+
+    // Offset of closer i of 'need' in summary (t, level)
+    size_t needAt(const DocNode* t, int level, size_t i) const {
+        size_t shift = 0;
+        while (level != SELF) {
+            const DocSummary& s = view(t, level);
+            const DocNode *a, *b;
+            int aLevel, bLevel;
+            parts(t, level, a, aLevel, b, bLevel);
+            if (i < s.aNeed) t = a, level = aLevel;
+            else {
+                shift += s.shiftB;
+                i = s.k + i - s.aNeed;
+                t = b, level = bLevel;
+            }
+        }
+        return shift + t->self.needAt[i];
+    }
+
+    // Whether the first m closers of B close the last m openers of A
+    bool closes(const DocNode* a, int aLevel, const DocNode* b, int bLevel, size_t m) const {
+        const DocSummary& sa = view(a, aLevel);
+        // Last m openers of A, read backwards: x^(openLen - 1) * (openHash - openPrefix(openLen - m))
+        uint64_t last = mul(mul(sa.openPow, xInv), sub(sa.openHash, openPrefix(a, aLevel, sa.openLen - m)));
+        return last == needPrefix(b, bLevel, m);
+    }
+
+    // Set summary (t, level) to its part A followed by its part B, which
+    // starts 'shiftB' bytes after A
+    void compose(DocNode* t, int level, size_t shiftB) {
+        const DocNode *a, *b;
+        int aLevel, bLevel;
+        parts(t, level, a, aLevel, b, bLevel);
+        const DocSummary& sa = view(a, aLevel);
+        const DocSummary& sb = view(b, bLevel);
+        DocSummary& r = level == PREFIX ? t->prefix : t->all;
+
+        r = sa;                     // A with an error, or a mismatch at the cut, stays A
+        r.aNeed = sa.needLen;
+        r.aOpenKept = sa.openLen;
+        r.k = 0;
+        r.shiftB = shiftB;
+        r.aNeedHash = sa.needHash;
+        r.aNeedPow = sa.needPow;
+        r.bNeedPreK = 0;
+        r.negK = 1;
+        r.aOpenKeptHash = sa.openHash;
+        r.negKept = sa.openPowInv;
+        if (sa.err != NO_BRACKET_ERROR) return;
+
+        size_t k = std::min(sa.openLen, sb.needLen);
+        if (k && !closes(a, aLevel, b, bLevel, k)) {
+            size_t lo = 1, hi = k;      // Shortest prefix of B's closers that mismatches
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (closes(a, aLevel, b, bLevel, mid)) lo = mid + 1;
+                else hi = mid;
+            }
+            r.err = shiftB + needAt(b, bLevel, lo - 1);
+            return;
+        }
+
+        bool aOpenUsed = (k == sa.openLen);
+        uint64_t negK = aOpenUsed ? sa.openPowInv : sb.needPowInv;
+        uint64_t posK = aOpenUsed ? sa.openPow : sb.needPow;
+        r.k = k;
+        r.bNeedPreK = needPrefix(b, bLevel, k);
+        r.negK = negK;
+        r.aOpenKept = sa.openLen - k;
+        r.aOpenKeptHash = openPrefix(a, aLevel, r.aOpenKept);
+        r.negKept = mul(sa.openPowInv, posK);
+
+        r.needLen = sa.needLen + sb.needLen - k;
+        r.needHash = add(sa.needHash, mul(mul(sa.needPow, negK), sub(sb.needHash, r.bNeedPreK)));
+        r.needPow = mul(mul(sa.needPow, sb.needPow), negK);
+        r.needPowInv = mul(mul(sa.needPowInv, sb.needPowInv), posK);
+        r.openLen = r.aOpenKept + sb.openLen;
+        r.openHash = add(r.aOpenKeptHash, mul(r.negKept, sb.openHash));
+        r.openPow = mul(mul(sa.openPow, negK), sb.openPow);
+        r.openPowInv = mul(r.negKept, sb.openPowInv);
+        r.err = sb.err == NO_BRACKET_ERROR ? NO_BRACKET_ERROR : shiftB + sb.err;
+    }
+
+    // Rescan the block of t and rebuild its own summary
+    void summarizeBlock(DocNode* t) {
+        t->self = BracketSummary::reduce(t->text.data(), t->text.size(), 0);
+        DocSummary& s = t->selfSum;
+        s = none;
+        s.err = t->self.error;
+        s.needLen = t->self.need.size();
+        s.openLen = t->self.open.size();
+        t->needPre.assign(1, 0);
+        for (char c : t->self.need) {
+            uint64_t opener = (unsigned char)DefaultGrammar::table.match[(unsigned char)c];
+            t->needPre.push_back(add(t->needPre.back(), mul(opener, s.needPow)));
+            s.needPow = mul(s.needPow, x);
+            s.needPowInv = mul(s.needPowInv, xInv);
+        }
+        t->openPre.assign(1, 0);
+        for (char c : t->self.open) {
+            t->openPre.push_back(add(t->openPre.back(), mul((unsigned char)c, s.openPowInv)));
+            s.openPow = mul(s.openPow, x);
+            s.openPowInv = mul(s.openPowInv, xInv);
+        }
+        s.needHash = t->needPre.back();
+        s.openHash = t->openPre.back();
+    }
+
+    DocNode* makeNode(const std::string& text) {
+        DocNode* t = new DocNode(text, random());
+        summarizeBlock(t);
+        pull(t);
+        return t;
+    }
+
+    // Recompute the length and summaries of t from its block and children
+    void pull(DocNode* t) {
+        size_t l = len(t->left);
+        t->len = l + t->text.size() + len(t->right);
+        compose(t, PREFIX, l);
+        compose(t, ALL, l + t->text.size());
+    }
+
+    DocNode* merge(DocNode* a, DocNode* b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->prio > b->prio) {
+            a->right = merge(a->right, b);
+            pull(a);
+            return a;
+        }
+        b->left = merge(a, b->left);
+        pull(b);
+        return b;
+    }
+
+    // Split t into the first 'pos' bytes (a) and the rest (b), cutting a
+    // block in two if 'pos' falls inside it
+    void split(DocNode* t, size_t pos, DocNode*& a, DocNode*& b) {
+        if (!t) {
+            a = b = nullptr;
+            return;
+        }
+        size_t l = len(t->left);
+        if (pos <= l) {
+            split(t->left, pos, a, t->left);
+            pull(t);
+            b = t;
+        } else if (pos >= l + t->text.size()) {
+            split(t->right, pos - l - t->text.size(), t->right, b);
+            pull(t);
+            a = t;
+        } else {
+            size_t k = pos - l;
+            DocNode* rest = makeNode(t->text.substr(k));
+            DocNode* right = t->right;
+            t->text.resize(k);
+            summarizeBlock(t);
+            t->right = nullptr;
+            pull(t);
+            a = t;
+            b = merge(rest, right);
+        }
+    }
+
+    // Insert into the block holding 'pos' if it stays small enough; returns
+    // false (and changes nothing) otherwise
+    bool insertInBlock(DocNode* t, size_t pos, const std::string& text) {
+        size_t l = len(t->left);
+        bool done;
+        if (t->left && pos <= l) done = insertInBlock(t->left, pos, text);
+        else if (pos - l <= t->text.size()) {
+            if (t->text.size() + text.size() > 2 * DOC_BLOCK_SIZE) return false;
+            t->text.insert(pos - l, text);
+            summarizeBlock(t);
+            done = true;
+        } else done = insertInBlock(t->right, pos - l - t->text.size(), text);
+        if (done) pull(t);
+        return done;
+    }
+
+    // Erase inside the block holding [pos, pos + n) if there is one; returns
+    // false (and changes nothing) if the range spans several blocks. 'start'
+    // receives the offset of the block, or NO_BRACKET_ERROR if the block
+    // became empty and was removed.
+    bool eraseInBlock(DocNode*& t, size_t pos, size_t n, size_t& start) {
+        if (!t) return false;
+        size_t l = len(t->left);
+        bool done;
+        if (pos < l) done = eraseInBlock(t->left, pos, n, start);
+        else if (pos - l < t->text.size()) {
+            if (pos - l + n > t->text.size()) return false;
+            t->text.erase(pos - l, n);
+            if (t->text.empty()) {
+                DocNode* gone = t;
+                t = merge(t->left, t->right);
+                delete gone;
+                start = NO_BRACKET_ERROR;
+                return true;
+            }
+            summarizeBlock(t);
+            start = l;
+            done = true;
+        } else {
+            done = eraseInBlock(t->right, pos - l - t->text.size(), n, start);
+            if (done && start != NO_BRACKET_ERROR) start += l + t->text.size();
+        }
+        if (done) pull(t);
+        return done;
+    }
+
+    // Offset and size of the block holding byte 'pos' (pos < size())
+    void locate(size_t pos, size_t& start, size_t& bytes) const {
+        const DocNode* t = root;
+        start = 0;
+        while (true) {
+            size_t l = len(t->left);
+            if (pos < l) t = t->left;
+            else if (pos - l < t->text.size()) {
+                start += l;
+                bytes = t->text.size();
+                return;
+            } else {
+                start += l + t->text.size();
+                pos -= l + t->text.size();
+                t = t->right;
+            }
+        }
+    }
+
+    // While the block holding byte 'pos' is smaller than DOC_MIN_BLOCK,
+    // merge it with the next block (or the previous one, for the last
+    // block), splitting the result in two if it is too large
+    void compactAt(size_t pos) {
+        while (pos < size()) {
+            size_t lo, bytes;
+            locate(pos, lo, bytes);
+            if (bytes >= DOC_MIN_BLOCK) return;
+            size_t hi = lo + bytes;
+            if (hi < size()) {
+                size_t next;
+                locate(hi, hi, next);
+                hi += next;
+            } else if (lo > 0) {
+                size_t prev;
+                locate(lo - 1, lo, prev);
+            } else return;              // The only block
+
+            DocNode *a, *m, *c;
+            split(root, lo, a, m);
+            split(m, hi - lo, m, c);
+            std::string s;
+            s.reserve(hi - lo);
+            append(s, m);
+            destroy(m);
+            if (s.size() <= 2 * DOC_BLOCK_SIZE) m = makeNode(s);
+            else m = merge(makeNode(s.substr(0, s.size() / 2)), makeNode(s.substr(s.size() / 2)));
+            root = merge(merge(a, m), c);
+        }
+    }
+
+    static void append(std::string& s, const DocNode* t) {
+        if (!t) return;
+        append(s, t->left);
+        s += t->text;
+        append(s, t->right);
+    }
+
+    static void destroy(DocNode* t) {
+        if (!t) return;
+        destroy(t->left);
+        destroy(t->right);
+        delete t;
+    }
+
+};
+
+#endif
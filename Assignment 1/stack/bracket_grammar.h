@@ -0,0 +1,168 @@
+#ifndef __BracketGrammar_H
+#define __BracketGrammar_H
+
+#include <cstddef>
+
+// Table-driven bracket grammars
+// -----------------------------
+//
+// A grammar lists its bracket pairs, and optionally a quote character and an
+// escape character:
+//
+//     typedef BracketGrammar<BracketPairs<'(', ')', '<', '>'>, '"', '\\'> MyGrammar;
+//
+// At compile time this generates two 256-entry tables: the class of every
+// byte (text, opening, closing, quote or escape) and, for every closing
+// bracket, the opening bracket it matches. The validator core then does one
+// table lookup per byte instead of a chain of comparisons.
+//
+// Between two quote characters brackets are ignored. The escape character
+// makes the next byte plain text, inside or outside quotes. An unterminated
+// quote makes the input invalid, with the error at the end of the input.
+
+#define NO_BRACKET_ERROR ((size_t)-1)
+
+enum ByteClass { BYTE_TEXT = 0, BYTE_OPEN, BYTE_CLOSE, BYTE_QUOTE, BYTE_ESCAPE };
+
+// Bracket pairs, as opening and closing characters one after the other
+template <char... Chars>
+struct BracketPairs {
+    static_assert(sizeof...(Chars) % 2 == 0, "BracketPairs needs an even number of characters");
+};
+
+struct GrammarTable {
+    unsigned char cls[256];     // ByteClass of every byte
+    char match[256];            // Opening bracket for every closing bracket, as stacked
+};
+
+template <char... Chars>
+constexpr GrammarTable makeGrammarTable(char quote, char escape) {
+    GrammarTable t = {};
+    const char pairs[] = {Chars..., 0};
+    for (size_t i = 0; i + 1 < sizeof...(Chars); i += 2) {
+        t.cls[(unsigned char)pairs[i]] = BYTE_OPEN;
+        t.cls[(unsigned char)pairs[i + 1]] = BYTE_CLOSE;
+        t.match[(unsigned char)pairs[i + 1]] = pairs[i];
+    }
+    if (quote) t.cls[(unsigned char)quote] = BYTE_QUOTE;
+    if (escape) t.cls[(unsigned char)escape] = BYTE_ESCAPE;
+    return t;
+}
+
+template <class Pairs, char Quote = 0, char Escape = 0>
+struct BracketGrammar;
+
+template <char... Chars, char Quote, char Escape>
+struct BracketGrammar<BracketPairs<Chars...>, Quote, Escape> {
+    static constexpr GrammarTable table = makeGrammarTable<Chars...>(Quote, Escape);
+    static constexpr bool hasQuotes = (Quote != 0 || Escape != 0);
+    static constexpr char quote = Quote;
+    static constexpr char escape = Escape;
+};
+
+template <char... Chars, char Quote, char Escape>
+constexpr GrammarTable BracketGrammar<BracketPairs<Chars...>, Quote, Escape>::table;
+
+// The grammar of isValidString: (), [] and {}, no quotes
+typedef BracketGrammar<BracketPairs<'(', ')', '[', ']', '{', '}'>> DefaultGrammar;
+
+// Validator core shared by every grammar and stack type. S can be any stack
+// of char with push, pop, top and empty (Stack<char>, std::stack<char>...).
+// Input can be fed in chunks; the stack, quote and escape state are kept
+// in between.
+template <class G, class S>
+class GrammarCore {
+public:
+    S st;
+    size_t offset;     // Number of bytes fed so far
+    size_t error;      // Offset of the first mismatch, or NO_BRACKET_ERROR
+    bool inQuote;
+    bool escaped;      // The next byte is escaped
+
+    GrammarCore() : offset(0), error(NO_BRACKET_ERROR), inQuote(false), escaped(false) {}
+
+    // Validate the next n bytes; returns false once the input is invalid
+    bool feed(const char* p, size_t n) {
+        if (error != NO_BRACKET_ERROR) return false;
+        size_t i = 0;
+        if (escaped && n) {
+            escaped = false;
+            i = 1;
+        }
+        for (; i < n; ++ i) {
+            unsigned char k = G::table.cls[(unsigned char)p[i]];
+            if (k != BYTE_TEXT && !step(p, i, n, k)) return false;
+        }
+        offset += n;
+        return true;
+    }
+
+    // Same as feed(p, n), but only the bytes 'find' stops at are looked at.
+    // find(s, m) returns the index of the first byte of s[0 .. m) that is not
+    // text in G, or m (see bracketFinder in bracket_scan.h).
+    template <class Find>
+    bool feed(const char* p, size_t n, Find find) {
+        if (error != NO_BRACKET_ERROR) return false;
+        size_t i = 0;
+        if (escaped && n) {
+            escaped = false;
+            i = 1;
+        }
+        for (i += find(p + i, n - i); i < n; i += 1 + find(p + i + 1, n - i - 1)) {
+            if (!step(p, i, n, G::table.cls[(unsigned char)p[i]])) return false;
+        }
+        offset += n;
+        return true;
+    }
+
+    // Handle p[i], of class k (not text). An escape also consumes the byte
+    // after it, so i may be advanced by one.
+    bool step(const char* p, size_t& i, size_t n, unsigned char k) {
+        if (G::hasQuotes) {
+            if (k == BYTE_ESCAPE) {
+                if (i + 1 == n) escaped = true;
+                else ++ i;
+                return true;
+            }
+            if (k == BYTE_QUOTE) {
+                inQuote = !inQuote;
+                return true;
+            }
+            if (inQuote) return true;
+        }
+        char c = p[i];
+        if (k == BYTE_OPEN) st.push(c);
+        else if (st.empty() || st.top() != G::table.match[(unsigned char)c]) {
+            offset += i;    // Bytes up to the mismatch
+            error = offset;
+            return false;
+        } else st.pop();
+        return true;
+    }
+
+    // End of input: an open bracket or quote left is an error at the end
+    bool finish() {
+        if (error != NO_BRACKET_ERROR) return false;
+        if (!st.empty() || inQuote) error = offset;
+        return error == NO_BRACKET_ERROR;
+    }
+
+    // Get ready for a new input; the stack keeps its memory if it can
+    void reset() {
+        while (!st.empty()) st.pop();
+        offset = 0;
+        error = NO_BRACKET_ERROR;
+        inQuote = escaped = false;
+    }
+
+};
+
+// Check s[0 .. n) against grammar G using a stack of type S
+template <class G, class S>
+inline bool isValidGrammar(const char* s, size_t n) {
+    GrammarCore<G, S> core;
+    core.feed(s, n);
+    return core.finish();
+}
+
+#endif
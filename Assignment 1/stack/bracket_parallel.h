@@ -0,0 +1,192 @@
+#ifndef __BracketParallel_H
+#define __BracketParallel_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "stack.h"
+
+// Parallel bracket validation
+// ---------------------------
+//
+// The input is split into one chunk per thread and every chunk is reduced
+// on its own to a GrammarSummary:
+//
+//   need  - the closing brackets the chunk could not match, in input order,
+//           which must be matched by openers from earlier chunks
+//   open  - the opening brackets left unmatched at the end of the chunk,
+//           bottom of the stack first
+//
+// A mismatch inside a chunk, e.g. "(]", is an error whatever comes before
+// it, so the chunk records its offset and stops. Summaries are combined in
+// input order with merge() (append() in place), which matches the left
+// side's 'open' against the right side's 'need'. merge() is associative, so
+// the chunks can be reduced independently and combined afterwards.
+//
+// With a grammar that has quotes, a chunk also has to know whether it starts
+// inside a quote or right after an escape. An escape is only ever escaped
+// by another escape, so the second is given by the parity of the run of
+// escapes just before the chunk. The first is the parity of the unescaped
+// quotes in all earlier chunks, which a first parallel pass counts.
+
+template <class G = DefaultGrammar>
+class GrammarSummary {
+public:
+    std::string need;
+    std::vector<size_t> needAt;   // Offset of each closer in 'need'
+    std::string open;
+    size_t error;                 // Offset of the first mismatch, or NO_BRACKET_ERROR
+
+    GrammarSummary() : error(NO_BRACKET_ERROR) {}
+
+    // Summary of p[0 .. n), which starts at byte 'base' of the whole input,
+    // inside a quote if 'inQuote' and with p[0] escaped if 'escaped'
+    static GrammarSummary reduce(const char* p, size_t n, size_t base, BracketFinder find = bracketFinder<G>(),
+                                 bool inQuote = false, bool escaped = false) {
+        GrammarSummary r;
+        for (size_t i = (escaped && n) ? 1 + find(p + 1, n - 1) : find(p, n); i < n; i += 1 + find(p + i + 1, n - i - 1)) {
+            char c = p[i];
+            unsigned char k = G::table.cls[(unsigned char)c];
+            if (G::hasQuotes) {
+                if (k == BYTE_ESCAPE) {
+                    if (i + 1 < n) ++ i;
+                    continue;
+                }
+                if (k == BYTE_QUOTE) {
+                    inQuote = !inQuote;
+                    continue;
+                }
+                if (inQuote) continue;
+            }
+            if (k == BYTE_OPEN) r.open.push_back(c);
+            else if (r.open.empty()) {
+                r.need.push_back(c);
+                r.needAt.push_back(base + i);
+            } else if (r.open.back() != G::table.match[(unsigned char)c]) {
+                r.error = base + i;
+                break;
+            } else r.open.pop_back();
+        }
+        return r;
+    }
+
+    // Extend this summary with the input covered by 'b', which directly
+    // follows it. 'shift' is added to the offsets of 'b', for summaries
+    // whose offsets are relative to their own start.
+    void append(const GrammarSummary& b, size_t shift = 0) {
+        if (error != NO_BRACKET_ERROR) return;
+        for (size_t i = 0; i < b.need.size(); ++ i) {
+            char c = b.need[i];
+            if (open.empty()) {
+                need.push_back(c);
+                needAt.push_back(b.needAt[i] + shift);
+            } else if (open.back() != G::table.match[(unsigned char)c]) {
+                error = b.needAt[i] + shift;
+                return;
+            } else open.pop_back();
+        }
+        if (b.error != NO_BRACKET_ERROR) error = b.error + shift;
+        open += b.open;
+    }
+
+    // Summary of the input covered by 'a' followed by the input covered by 'b'
+    static GrammarSummary merge(const GrammarSummary& a, const GrammarSummary& b) {
+        GrammarSummary r = a;
+        r.append(b);
+        return r;
+    }
+
+    // Offset of the first error in an input of n bytes summarized by this,
+    // or NO_BRACKET_ERROR if the input is valid
+    size_t firstError(size_t n) const {
+        if (!need.empty()) return needAt[0] < error ? needAt[0] : error;
+        if (error != NO_BRACKET_ERROR) return error;
+        return open.empty() ? NO_BRACKET_ERROR : n;
+    }
+
+    // Whether p[begin] is escaped, from the run of escapes before it
+    static bool escapedAt(const char* p, size_t begin) {
+        if (!G::escape) return false;
+        size_t run = 0;
+        while (run < begin && p[begin - 1 - run] == G::escape) ++ run;
+        return run % 2 == 1;
+    }
+
+    // Number of unescaped quotes in p[begin .. end)
+    static size_t countQuotes(const char* p, size_t begin, size_t end) {
+        size_t quotes = 0;
+        for (size_t i = escapedAt(p, begin) ? begin + 1 : begin; i < end; ++ i) {
+            if (G::escape && p[i] == G::escape) ++ i;
+            else if (p[i] == G::quote) ++ quotes;
+        }
+        return quotes;
+    }
+
+};
+
+typedef GrammarSummary<> BracketSummary;
+
+// Check p[0 .. n) against grammar G with 'threads' threads (0 means one per
+// core). If 'errorOffset' is given, it receives the offset of the first
+// mismatch, as reported by GrammarValidator<G>.
+template <class G = DefaultGrammar>
+inline bool isValidStringParallel(const char* p, size_t n, int threads = 0, size_t* errorOffset = nullptr) {
+    if (threads <= 0) {
+        static const int cores = std::thread::hardware_concurrency();
+        threads = cores;
+        if ((size_t)threads > n / 65536) threads = n / 65536;  // Not worth a thread for small inputs
+        if (threads <= 0) threads = 1;
+    }
+    if ((size_t)threads > n) threads = n ? n : 1;
+    size_t chunk = n / threads;
+
+    // Run f(t, begin, end) for every chunk, the last one on this thread
+    auto forEachChunk = [&](auto f) {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++ t) {
+            size_t begin = t * chunk;
+            size_t end = (t == threads - 1) ? n : begin + chunk;
+            if (t == threads - 1) f(t, begin, end);
+            else pool.emplace_back(f, t, begin, end);
+        }
+        for (std::thread& th : pool) th.join();
+    };
+
+    std::vector<char> startsInQuote(threads, 0);
+    bool openQuote = false;
+    if (G::quote) {
+        std::vector<size_t> quotes(threads);
+        forEachChunk([&quotes, p](int t, size_t begin, size_t end) {
+            quotes[t] = GrammarSummary<G>::countQuotes(p, begin, end);
+        });
+        size_t total = 0;
+        for (int t = 0; t < threads; ++ t) {
+            startsInQuote[t] = total % 2;
+            total += quotes[t];
+        }
+        openQuote = total % 2;
+    }
+
+    std::vector<GrammarSummary<G>> parts(threads);
+    forEachChunk([&parts, &startsInQuote, p](int t, size_t begin, size_t end) {
+        parts[t] = GrammarSummary<G>::reduce(p + begin, end - begin, begin, bracketFinder<G>(), startsInQuote[t],
+                                             GrammarSummary<G>::escapedAt(p, begin));
+    });
+
+    GrammarSummary<G>& total = parts[0];
+    for (int t = 1; t < threads; ++ t) total.append(parts[t]);
+
+    size_t error = total.firstError(n);
+    if (error == NO_BRACKET_ERROR && openQuote) error = n;  // Unterminated quote
+    if (errorOffset) *errorOffset = error;
+    return error == NO_BRACKET_ERROR;
+}
+
+template <class G = DefaultGrammar>
+inline bool isValidStringParallel(const std::string& s, int threads = 0) {
+    return isValidStringParallel<G>(s.data(), s.size(), threads);
+}
+
+#endif
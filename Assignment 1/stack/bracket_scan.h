@@ -0,0 +1,144 @@
+#ifndef __BracketScan_H
+#define __BracketScan_H
+
+#include <cstddef>
+
+#include "bracket_grammar.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BRACKET_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// Finding the next bracket in a buffer
+// ------------------------------------
+//
+// Each find function returns the index of the first byte of s[0 .. n) that
+// grammar G does not treat as text (a bracket, or its quote or escape
+// character), or n if there is none. The vector versions classify 16 or 32
+// bytes at once with two nibble lookups; for the default grammar:
+//
+//   byte  hi lo     lo table          hi table
+//    (    2  8      8, 9 -> 0x01      2 -> 0x01
+//    )    2  9      B, D -> 0x06      5 -> 0x02
+//    [    5  B                        7 -> 0x04
+//    ]    5  D
+//    {    7  B
+//    }    7  D
+//
+// A byte is a bracket exactly when lo_table[lo] & hi_table[hi] != 0, so the
+// lookups are a pair of byte shuffles, an AND and a compare per block. Whole
+// blocks of non-bracket text are skipped with a single test.
+//
+// The tables are built from G's class table at compile time: each distinct
+// high nibble gets one bit, and lo_table[lo] holds the bits of the high
+// nibbles that form a bracket with lo. That is exact as long as the
+// grammar's bytes have at most 8 distinct high nibbles; grammars with more
+// use the scalar finder.
+
+typedef size_t (*BracketFinder)(const char* s, size_t n);
+
+struct NibbleTables {
+    unsigned char lo[16], hi[16];
+    bool exact;     // At most 8 distinct high nibbles
+};
+
+constexpr NibbleTables makeNibbleTables(const GrammarTable& g) {
+    NibbleTables t = {};
+    t.exact = true;
+    int bits = 0;
+    for (int c = 0; c < 256; ++ c) {
+        if (g.cls[c] == BYTE_TEXT) continue;
+        int h = c >> 4;
+        if (!t.hi[h]) {
+            if (bits == 8) t.exact = false;
+            else t.hi[h] = (unsigned char)(1 << bits ++);
+        }
+        t.lo[c & 15] |= t.hi[h];
+    }
+    return t;
+}
+
+template <class G>
+struct GrammarNibbles {
+    static constexpr NibbleTables tables = makeNibbleTables(G::table);
+};
+
+template <class G>
+constexpr NibbleTables GrammarNibbles<G>::tables;
+
+template <class G = DefaultGrammar>
+inline bool isBracket(char c) {
+    return G::table.cls[(unsigned char)c] != BYTE_TEXT;
+}
+
+template <class G = DefaultGrammar>
+inline size_t findBracketScalar(const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n && !isBracket<G>(s[i])) ++ i;
+    return i;
+}
+
+#ifdef BRACKET_SCAN_X86
+
+template <class G = DefaultGrammar>
+__attribute__((target("ssse3")))
+inline size_t findBracketSsse3(const char* s, size_t n) {
+    const __m128i loTable = _mm_loadu_si128((const __m128i*)GrammarNibbles<G>::tables.lo);
+    const __m128i hiTable = _mm_loadu_si128((const __m128i*)GrammarNibbles<G>::tables.hi);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i lo = _mm_shuffle_epi8(loTable, _mm_and_si128(v, nibble));
+        __m128i hi = _mm_shuffle_epi8(hiTable, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        __m128i hit = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero);
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(hit) & 0xffff;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findBracketScalar<G>(s + i, n - i);
+}
+
+template <class G = DefaultGrammar>
+__attribute__((target("avx2")))
+inline size_t findBracketAvx2(const char* s, size_t n) {
+    const __m256i loTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)GrammarNibbles<G>::tables.lo));
+    const __m256i hiTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)GrammarNibbles<G>::tables.hi));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i lo = _mm256_shuffle_epi8(loTable, _mm256_and_si256(v, nibble));
+        __m256i hi = _mm256_shuffle_epi8(hiTable, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        __m256i hit = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), zero);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(hit);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + findBracketSsse3<G>(s + i, n - i);
+}
+
+#endif
+
+// Pick the widest find function the running CPU supports for grammar G
+template <class G = DefaultGrammar>
+inline BracketFinder selectBracketFinder() {
+#ifdef BRACKET_SCAN_X86
+    if (GrammarNibbles<G>::tables.exact) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return findBracketAvx2<G>;
+        if (__builtin_cpu_supports("ssse3")) return findBracketSsse3<G>;
+    }
+#endif
+    return findBracketScalar<G>;
+}
+
+// The find function used by isValidStringSimd, chosen once per process
+template <class G = DefaultGrammar>
+inline BracketFinder bracketFinder() {
+    static const BracketFinder f = selectBracketFinder<G>();
+    return f;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef __BracketValidator_H
+#define __BracketValidator_H
+
+#include <cstddef>
+
+#include "stack.h"
+
+// Streaming version of isValidString. The input is given in chunks with
+// feed() and the open brackets are kept on a Stack between chunks, so the
+// memory used depends on the nesting depth only, not on the input size.
+// Text between brackets is skipped with the scanner from bracket_scan.h.
+//
+//     BracketValidator v;
+//     while (...) v.feed(buf, n);
+//     if (!v.finish()) std::cout << "error at byte " << v.errorOffset();
+//
+// GrammarValidator<G> does the same for any grammar from bracket_grammar.h,
+// quotes and escapes included.
+template <class G = DefaultGrammar>
+class GrammarValidator : public GrammarCore<G, Stack<char>> {
+public:
+    typedef GrammarCore<G, Stack<char>> Core;
+
+    BracketFinder find;
+
+    GrammarValidator(BracketFinder f = bracketFinder<G>()) : find(f) {}
+
+    // Validate the next n bytes of the input. Returns false as soon as the
+    // input is known to be invalid; later calls are then ignored.
+    bool feed(const char* p, size_t n) {
+        return Core::feed(p, n, find);
+    }
+
+    // Byte offset of the first mismatch (only meaningful after a failure)
+    size_t errorOffset() const {
+        return this->error;
+    }
+
+};
+
+typedef GrammarValidator<> BracketValidator;
+
+#endif
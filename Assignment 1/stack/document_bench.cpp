@@ -0,0 +1,164 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#include "bracket_document.h"
+#include "bracket_validator.h"
+#include "input_gen.h"
+#include "../bench.h"
+
+// Status of s computed from scratch
+DocumentStatus rescan(const std::string& s) {
+    BracketValidator v;
+    v.feed(s.data(), s.size());
+    bool valid = v.finish();
+    return {valid, v.errorOffset()};
+}
+
+// Apply random edits to a small document and compare status() with a full
+// rescan after each one
+bool check_document() {
+    std::mt19937 rng(1);
+    const char* alphabets[] = {"()[]{}ab", "(((([{a", "()))]}a"};
+    for (int doc = 0; doc < 300; ++ doc) {
+        const char* alphabet = alphabets[doc % 3];
+        BracketDocument d;
+        std::string s;
+        for (int e = 0; e < 300; ++ e) {
+            size_t pos = rng() % (s.size() + 1);
+            if (rng() % 3 == 0 && !s.empty()) {
+                size_t n = 1 + rng() % (rng() % 8 ? 3 : 3 * DOC_BLOCK_SIZE);
+                d.erase(pos, n);
+                if (pos < s.size()) s.erase(pos, n);
+            } else {
+                std::string text(rng() % 8 ? 1 + rng() % 4 : rng() % (3 * DOC_BLOCK_SIZE), ' ');
+                for (char& c : text) c = alphabet[rng() % strlen(alphabet)];
+                d.insert(pos, text);
+                s.insert(pos, text);
+            }
+            DocumentStatus got = d.status(), want = rescan(s);
+            if (d.text() != s || got.valid != want.valid || (!got.valid && got.error != want.error)) {
+                std::cerr << "Document " << doc << " differs from a rescan after edit " << e << "\n";
+                return false;
+            }
+            if (d.blocks() > s.size() / DOC_MIN_BLOCK + 1) {
+                std::cerr << "Document " << doc << " keeps " << d.blocks() << " blocks for " << s.size() << " bytes\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Same, on documents of many blocks nested thousands deep, so that long runs
+// of brackets are matched across blocks
+bool check_deep_document() {
+    std::mt19937 rng(3);
+    const char alphabet[] = "()[]{}a";
+    for (int doc = 0; doc < 30; ++ doc) {
+        std::string s, closers;
+        for (int i = 1000 + rng() % 3000; i > 0; -- i) {
+            int type = rng() % 3;
+            s += "([{"[type];
+            closers += ")]}"[type];
+            if (rng() % 2) s += 'a';
+        }
+        std::reverse(closers.begin(), closers.end());
+        s += closers;
+        BracketDocument d;
+        d.insert(0, s);
+        for (int e = 0; e < 200 && !s.empty(); ++ e) {
+            size_t pos = rng() % s.size();
+            if (rng() % 2) {
+                size_t n = rng() % 4 ? 1 : 1 + rng() % (2 * DOC_BLOCK_SIZE);
+                d.erase(pos, n);
+                s.erase(pos, n);
+            } else {
+                std::string c(1, alphabet[rng() % 7]);
+                d.insert(pos, c);
+                s.insert(pos, c);
+            }
+            DocumentStatus got = d.status(), want = rescan(s);
+            if (got.valid != want.valid || (!got.valid && got.error != want.error)) {
+                std::cerr << "Deep document " << doc << " differs from a rescan after edit " << e << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Print min/median/p99 of the latencies in 'ns'
+void report(const char* name, std::vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    std::cout << name << "\tmin " << ns.front() << " ns\tmedian " << ns[ns.size() / 2] << " ns\tp99 "
+              << ns[ns.size() * 99 / 100] << " ns\n";
+}
+
+// Time 'count' single-character inserts at random positions, with
+// characters from 'alphabet', each undone by an erase; every edit is
+// followed by status()
+void edit_latency(BracketDocument& d, const std::string& alphabet, int count, const std::string& name) {
+    typedef std::chrono::steady_clock clock;
+    std::mt19937 rng(2);
+    std::vector<double> inserts, erases;
+    for (int i = 0; i < count; ++ i) {
+        size_t pos = rng() % d.size();
+        std::string c(1, alphabet[rng() % alphabet.size()]);
+        auto start = clock::now();
+        d.insert(pos, c);
+        doNotOptimize(d.status());
+        inserts.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(clock::now() - start).count());
+
+        // Undo the insert, so the document keeps its size and validity
+        start = clock::now();
+        d.erase(pos, 1);
+        doNotOptimize(d.status());
+        erases.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(clock::now() - start).count());
+    }
+    report((name + " insert + status").c_str(), inserts);
+    report((name + " erase + status").c_str(), erases);
+}
+
+// Usage: document_bench [size in MB]
+// Builds a document (100 MB by default) and times single-character edits at
+// random positions, compared with revalidating the whole text
+int main(int argc, char* argv[]) {
+
+    if (!check_document() || !check_deep_document()) return 1;
+
+    GenOptions gen;
+    gen.length = (argc > 1 ? atol(argv[1]) : 100) << 20;
+    std::string s = generateInput(gen, 1);
+
+    typedef std::chrono::steady_clock clock;
+    auto start = clock::now();
+    BracketDocument d;
+    d.insert(0, s);
+    double buildS = std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start).count();
+    std::cout << "Built a " << (s.size() >> 20) << " MB document in " << buildS << " s, valid: " << d.status().valid << "\n";
+
+    start = clock::now();
+    DocumentStatus full = rescan(s);
+    double rescanNs = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(clock::now() - start).count();
+    std::cout << "Full rescan: " << rescanNs << " ns (valid: " << full.valid << ")\n";
+
+    edit_latency(d, "ab+ ", 100000, "text");
+    std::cout << "valid after text edits: " << d.status().valid << "\n";
+    edit_latency(d, "()[]{}ab", 100000, "bracket");
+    std::cout << d.blocks() << " blocks after the edits\n";
+
+    // The first half of the text replaced by openers that are never closed
+    BracketDocument u;
+    u.insert(0, std::string(s.size() / 2, '(') + s.substr(s.size() / 2));
+    std::cout << "With " << s.size() / 2 << " unmatched openers, valid: " << u.status().valid << "\n";
+    edit_latency(u, "()[]{}ab", 100000, "unmatched");
+
+    return 0;
+
+}
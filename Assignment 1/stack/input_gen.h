@@ -0,0 +1,65 @@
+#ifndef __InputGen_H
+#define __InputGen_H
+
+#include <cstddef>
+#include <string>
+#include <random>
+#include <vector>
+
+// Parameters of a generated bracket input
+struct GenOptions {
+    size_t length = 1 << 20;   // Number of bytes
+    int depth = 64;            // Maximum nesting depth
+    double density = 0.1;      // Fraction of the bytes that are brackets
+    bool valid = true;         // Whether the input must pass isValidString
+};
+
+// Generate an input following 'o'. The same seed always gives the same input.
+//
+// Brackets are placed with probability 'density'; a bracket opens with
+// probability 1/2 while the depth is below 'depth', and every open bracket
+// is closed before the end. An invalid input is made by changing the type
+// of one closing bracket, or by adding a stray one if there is none.
+inline std::string generateInput(const GenOptions& o, unsigned long seed) {
+    const char open[] = {'(', '[', '{'};
+    const char text[] = "abcxyz0123+-*/ @%$#";
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0, 1);
+
+    std::string s(o.length, ' ');
+    std::string st;
+    for (size_t i = 0; i < o.length; ++ i) {
+        size_t left = o.length - i;
+        bool mustClose = !st.empty() && left <= st.size();
+        if (mustClose || coin(rng) < o.density) {
+            bool canOpen = (int)st.size() < o.depth && left > st.size() + 1;
+            if (canOpen && (st.empty() || coin(rng) < 0.5)) {
+                st.push_back(open[rng() % 3]);
+                s[i] = st.back();
+                continue;
+            }
+            if (!st.empty()) {
+                char c = st.back();
+                st.pop_back();
+                s[i] = (c == '(') ? ')' : (c == '[') ? ']' : '}';
+                continue;
+            }
+        }
+        s[i] = text[rng() % (sizeof(text) - 1)];
+    }
+
+    if (!o.valid) {
+        std::vector<size_t> closers;
+        for (size_t i = 0; i < s.size(); ++ i) {
+            if (s[i] == ')' || s[i] == ']' || s[i] == '}') closers.push_back(i);
+        }
+        if (closers.empty()) s += ')';
+        else {
+            size_t i = closers[rng() % closers.size()];
+            s[i] = (s[i] == ')') ? ']' : (s[i] == ']') ? '}' : ')';
+        }
+    }
+    return s;
+}
+
+#endif
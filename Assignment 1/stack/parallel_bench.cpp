@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bracket_parallel.h"
+#include "bracket_validator.h"
+
+// Check isValidStringParallel against BracketValidator on random inputs,
+// for several thread counts
+bool check_parallel() {
+    const char alphabet[] = "()[]{}a";
+    srand(1);
+    for (int t = 0; t < 20000; ++ t) {
+        // Mostly balanced inputs, so that a good share of them is valid
+        std::string s;
+        int len = rand() % 60;
+        std::string open;
+        for (int i = 0; i < len; ++ i) {
+            int r = rand() % 10;
+            if (r < 4) {
+                char c = alphabet[2 * (rand() % 3)];
+                open.push_back(c);
+                s.push_back(c);
+            } else if (r < 8 && !open.empty()) {
+                char c = open.back() == '(' ? ')' : open.back() == '[' ? ']' : '}';
+                open.pop_back();
+                s.push_back(c);
+            } else s.push_back(alphabet[rand() % 7]);
+        }
+
+        BracketValidator v;
+        v.feed(s.data(), s.size());
+        bool expected = v.finish();
+        for (int threads = 1; threads <= 8; ++ threads) {
+            size_t error;
+            bool valid = isValidStringParallel(s.data(), s.size(), threads, &error);
+            if (valid != expected || (!valid && error != v.errorOffset())) {
+                std::cerr << threads << " threads disagree on " << s << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Usage: parallel_bench [size in MB]
+// Times isValidStringParallel on a valid synthetic input (1 GB by default)
+// for 1 to N threads, N being the number of cores
+int main(int argc, char* argv[]) {
+
+    if (!check_parallel()) return 1;
+
+    size_t size = (argc > 1 ? atol(argv[1]) : 1024) << 20;
+    std::string block = "{a+b[(c*d) - (e/f)]}; x[i] = (y[j] + z{k}); ";
+    std::string s;
+    s.reserve(size);
+    while (s.size() + block.size() <= size) s += block;
+
+    int cores = std::thread::hardware_concurrency();
+    if (cores <= 0) cores = 1;
+    double base = 0;
+    std::cout << "threads\ttime (s)\tGB/s\tspeedup\n";
+    std::vector<int> counts;
+    for (int threads = 1; threads < cores; threads *= 2) counts.push_back(threads);
+    counts.push_back(cores);
+    for (int threads : counts) {
+        auto start = std::chrono::steady_clock ::now();
+        bool valid = isValidStringParallel(s.data(), s.size(), threads);
+        auto stop = std::chrono::steady_clock ::now();
+        double sec = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+        if (!valid) {
+            std::cerr << "Unexpected result with " << threads << " threads\n";
+            return 1;
+        }
+        if (threads == 1) base = sec;
+        std::cout << threads << "\t" << sec << "\t" << s.size() / sec / 1e9 << "\t" << base / sec << "\n";
+    }
+
+    return 0;
+
+}
@@ -1,178 +1,30 @@
 #include <iostream>
 #include <cstdlib>
-#include <stack>
-#include <chrono>
+#include <vector>
 
-class Node {
-public:
-    char val;
-    Node* next;
+#include "../bench.h"
+#include "stack.h"
 
-    Node() = default;
-
-    Node(char c) : val(c), next(nullptr) {}
-};
-
-class LinkedList {
-public:
-    Node* root;
-
-    LinkedList() : root(nullptr) {}
-
-    // Method to append a character to the end of the linked list
-    void append(char c) {
-        if (!root) root = new Node(c);
-        else {
-            Node* tmp = root;
-            while (tmp->next) tmp = tmp->next;
-            tmp->next = new Node(c);
-        }
-    }
-
-    // Method to remove a character from the end of the linked list
-    void removeEnd() {
-        if (!root) return;
-        Node* prev = nullptr, *curr = root;
-        while (curr->next) {
-            prev = curr;
-            curr = curr->next;
-        }
-        if (!prev) {
-            delete curr;
-            root = nullptr;
-        } else {
-            prev->next = nullptr;
-            delete curr;
-        }
-    }
-
-    // Method to delete the whole list
-    void clean() {
-        Node* curr = root;
-        while (curr) {
-            Node* tmp = curr->next;
-            delete curr;
-            curr = tmp;
-        }
-        root = nullptr;
-    }
-
-    // Get the end character of list
-    char getEnd() {
-        if (!root) return '\0';
-        Node* tmp = root;
-        while (tmp->next) tmp = tmp->next;
-        return tmp->val;
-    }
-
-};
-
-class Stack {
-public:
-    LinkedList l;
-    int sz;
-
-    Stack() : sz(0), l(LinkedList()) {}
-
-    // Method to push a character to the stack
-    void push(char c) {
-        l.append(c);
-        ++ sz;
-    }
-
-    // Method the pop a character out of the stack
-    void pop() {
-        l.removeEnd();
-        -- sz;
-    }
-
-    // Do nothing
-    void noop() {
-        return;
-    }
-
-    char top() {
-        return l.getEnd();
-    }
-
-    // Get the size of the stack
-    int size() {
-        return sz;
-    }
-
-};
-
-// Function to check whether a string is valid (have equal number of opening and closing parentheses) or not using my own stack
-bool isValidString(std::string s) {
-    Stack st = Stack();
-    for (char c : s) {
-        if (c == '(' || c == '[' || c == '{') st.push(c);
-        else if (c == ')' || c == ']' || c == '}') {
-            if (st.size() == 0) return false;
-            char topChar = st.top();
-            switch(topChar) {
-            case '(':
-                if (c == '}' || c == ']') return false;
-                break;
-            case '[':
-                if (c == '}' || c == ')') return false;
-                break;
-            case '{':
-                if (c == ')' || c == ']') return false;
-                break;
-            }
-            st.pop();
-        }
-    }
-    int tmp = st.size();
-    return (tmp == 0);
-}
-
-// Function to check whether a string is valid (have equal number of opening and closing parentheses) or not using the standard library stack
-bool isValidStringStl(std::string s) {
-    std::stack<char> st;
-    for (char c : s) {
-        if (c == '(' || c == '[' || c == '{') st.push(c);
-        else if (c == ')' || c == ']' || c == '}') {
-            if (st.size() == 0) return false;
-            char topChar = st.top();
-            switch(topChar) {
-            case '(':
-                if (c == '}' || c == ']') return false;
-                break;
-            case '[':
-                if (c == '}' || c == ')') return false;
-                break;
-            case '{':
-                if (c == ')' || c == ']') return false;
-                break;
-            }
-            st.pop();
-        }
-    }
-    int tmp = st.size();
-    return (tmp == 0);
-}
-
-// Number of function calls to compare_runtime
-int no = 1;
+// Results of every call to compare_runtime
+std::vector<BenchResult> results;
 
 // Function to compare runtime
-void compare_runtime(std::string s) {
+void compare_runtime(const std::string& s) {
 
     std::cout << "Test case: " << s << "\n";
-    auto start = std::chrono::steady_clock ::now();
-    isValidString(s);
-    auto stop = std::chrono::steady_clock ::now();
-    std::cout << "\tUsing my own stack: " << std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count() << " ms\n";
-    start = std::chrono::steady_clock ::now();
-    isValidStringStl(s);
-    stop = std::chrono::steady_clock ::now();
-    std::cout << "\tUsing standard library's stack: " << std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count() << " ms\n";
+    BenchResult mine = runBench("my stack", [&]() { doNotOptimize(isValidString(s)); });
+    BenchResult stl = runBench("standard library's stack", [&]() { doNotOptimize(isValidStringStl(s)); });
+    std::cout << "\tUsing my own stack: " << mine.median << " ns (min " << mine.min << ", p99 " << mine.p99 << ")\n";
+    std::cout << "\tUsing standard library's stack: " << stl.median << " ns (min " << stl.min << ", p99 " << stl.p99 << ")\n";
+
+    mine.name = "my stack #" + std::to_string(results.size() / 2 + 1);
+    stl.name = "std::stack #" + std::to_string(results.size() / 2 + 1);
+    results.push_back(mine);
+    results.push_back(stl);
 
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
     // Compare runtime
     compare_runtime("{{{{}}}[][]((())");
@@ -191,6 +43,9 @@ int main() {
     compare_runtime("(((((()))))){[[]]{}}{}{}[][][][[[]]]");
     compare_runtime("{{{{}}}[355----++++][]((())");
 
+    // Pass "csv" or "json" to get every result in that format at the end
+    if (argc > 1) printResults(std::cout, results, argv[1]);
+
 
     // Uncomment the below code the try some test cases
 //    std::cout << std::boolalpha;
@@ -0,0 +1,282 @@
+#ifndef __Stack_H
+#define __Stack_H
+
+#include <string>
+#include <stack>
+#include <vector>
+#include <new>
+#include <utility>
+
+#include "bracket_scan.h"
+#include "bracket_grammar.h"
+
+// Number of nodes carved out of one heap allocation by NodePool
+#define NODE_SLAB_SIZE 256
+
+class Node {
+public:
+    char val;
+    Node* next;
+
+    Node() = default;
+
+    Node(char c) : val(c), next(nullptr) {}
+};
+
+// Slab allocator for Node. Nodes are carved out of NODE_SLAB_SIZE-sized
+// slabs and released nodes are kept on an intrusive free list (linked
+// through Node::next), so push/pop bursts recycle nodes without going back
+// to the global heap. Slabs are only returned to the heap by the destructor.
+class NodePool {
+public:
+    std::vector<Node*> slabs;
+    size_t cur;       // Index of the slab we are carving from
+    int used;         // Number of nodes carved from slabs[cur]
+    Node* freeList;
+
+    // Allocation counters
+    long slabAllocs;  // Heap allocations made by the pool
+    long nodeAllocs;  // Nodes handed out
+    long nodeFrees;   // Nodes given back one at a time
+
+    NodePool() : cur(0), used(0), freeList(nullptr), slabAllocs(0), nodeAllocs(0), nodeFrees(0) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        for (Node* slab : slabs) delete[] slab;
+    }
+
+    // Get a node holding c, from the free list if possible
+    Node* allocate(char c) {
+        Node* n;
+        if (freeList) {
+            n = freeList;
+            freeList = freeList->next;
+        } else {
+            if (cur < slabs.size() && used == NODE_SLAB_SIZE) {
+                ++ cur;
+                used = 0;
+            }
+            if (cur == slabs.size()) {
+                slabs.push_back(new Node[NODE_SLAB_SIZE]);
+                ++ slabAllocs;
+            }
+            n = &slabs[cur][used ++];
+        }
+        n->val = c;
+        n->next = nullptr;
+        ++ nodeAllocs;
+        return n;
+    }
+
+    // Put a single node back on the free list
+    void release(Node* n) {
+        n->next = freeList;
+        freeList = n;
+        ++ nodeFrees;
+    }
+
+    // Release every node at once; the slabs are kept for reuse
+    void reset() {
+        cur = 0;
+        used = 0;
+        freeList = nullptr;
+    }
+
+};
+
+// Singly linked list used as the storage of ListStack. Elements are inserted and
+// removed at the head (root), so every operation is O(1) instead of walking
+// the list to reach its end. Nodes come from the list's own NodePool.
+class LinkedList {
+public:
+    Node* root;
+    NodePool pool;
+
+    LinkedList() : root(nullptr) {}
+
+    // Method to insert a character at the front of the linked list
+    void prepend(char c) {
+        Node* n = pool.allocate(c);
+        n->next = root;
+        root = n;
+    }
+
+    // Method to remove a character from the front of the linked list
+    void removeFront() {
+        if (!root) return;
+        Node* tmp = root;
+        root = root->next;
+        pool.release(tmp);
+    }
+
+    // Method to delete the whole list
+    void clean() {
+        pool.reset();
+        root = nullptr;
+    }
+
+    // Get the front character of list
+    char getFront() {
+        if (!root) return '\0';
+        return root->val;
+    }
+
+};
+
+// Character stack on top of LinkedList
+class ListStack {
+public:
+    LinkedList l;
+    int sz;
+
+    ListStack() : sz(0) {}
+
+    // Method to push a character to the stack
+    void push(char c) {
+        l.prepend(c);
+        ++ sz;
+    }
+
+    // Method the pop a character out of the stack
+    void pop() {
+        l.removeFront();
+        -- sz;
+    }
+
+    // Method to remove every character from the stack
+    void clear() {
+        l.clean();
+        sz = 0;
+    }
+
+    // Do nothing
+    void noop() {
+        return;
+    }
+
+    char top() {
+        return l.getFront();
+    }
+
+    // Get the size of the stack
+    int size() {
+        return sz;
+    }
+
+};
+
+// Generic stack whose first InlineN elements live inside the object itself.
+// Only a stack deeper than InlineN spills to a heap buffer, which then grows
+// by doubling; the elements are moved over, so move-only T works too.
+// Shallow stacks (the common case for bracket nesting) never allocate.
+template <class T, size_t InlineN = 64>
+class Stack {
+    static_assert(InlineN > 0, "Stack needs at least one inline element");
+
+public:
+    alignas(T) unsigned char local[InlineN * sizeof(T)];
+    T* data;
+    size_t sz, cap;
+    long heapAllocs;  // Number of heap buffers allocated so far
+
+    Stack() : data((T*)local), sz(0), cap(InlineN), heapAllocs(0) {}
+
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
+
+    ~Stack() {
+        clear();
+        if (data != (T*)local) ::operator delete(data);
+    }
+
+    // Method to construct an element in place on top of the stack
+    template <class... Args>
+    T& emplace(Args&&... args) {
+        if (sz == cap) return grow(std::forward<Args>(args)...);
+        T* p = new (data + sz) T(std::forward<Args>(args)...);
+        ++ sz;
+        return *p;
+    }
+
+    // Method to push an element to the stack
+    void push(const T& x) {
+        emplace(x);
+    }
+
+    void push(T&& x) {
+        emplace(std::move(x));
+    }
+
+    // Method the pop an element out of the stack
+    void pop() {
+        if (sz == 0) return;
+        data[-- sz].~T();
+    }
+
+    // Method to remove every element; a heap buffer is kept for reuse
+    void clear() {
+        while (sz) data[-- sz].~T();
+    }
+
+    T& top() {
+        return data[sz - 1];
+    }
+
+    // Get the size of the stack
+    size_t size() const {
+        return sz;
+    }
+
+    bool empty() const {
+        return sz == 0;
+    }
+
+    // Move to a buffer twice as big, constructing the new top element first
+    // in case 'args' refers to an element of the current buffer
+    template <class... Args>
+    T& grow(Args&&... args) {
+        T* bigger = (T*)::operator new(2 * cap * sizeof(T));
+        ++ heapAllocs;
+        T* p = new (bigger + sz) T(std::forward<Args>(args)...);
+        for (size_t i = 0; i < sz; ++ i) {
+            new (bigger + i) T(std::move(data[i]));
+            data[i].~T();
+        }
+        if (data != (T*)local) ::operator delete(data);
+        data = bigger;
+        cap *= 2;
+        ++ sz;
+        return *p;
+    }
+
+};
+
+// Function to check whether a string is valid (have equal number of opening and closing parentheses) or not using my own stack
+inline bool isValidString(const std::string& s) {
+    return isValidGrammar<DefaultGrammar, Stack<char>>(s.data(), s.size());
+}
+
+// Function to check whether a string is valid (have equal number of opening and closing parentheses) or not using the standard library stack
+inline bool isValidStringStl(const std::string& s) {
+    return isValidGrammar<DefaultGrammar, std::stack<char>>(s.data(), s.size());
+}
+
+// Get the opening bracket that closes with c
+inline char matchingOpen(char c) {
+    return DefaultGrammar::table.match[(unsigned char)c];
+}
+
+// Same as isValidString, but the non-bracket text between brackets is skipped
+// with the vector scanner from bracket_scan.h, so only bracket positions reach
+// the stack. 'find' can be overridden to compare scanners; G is the grammar.
+template <class G = DefaultGrammar>
+inline bool isValidStringSimd(const std::string& s, BracketFinder find = bracketFinder<G>()) {
+    GrammarCore<G, Stack<char>> core;
+    core.feed(s.data(), s.size(), find);
+    return core.finish();
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+
+#include "stack.h"
+
+// Build a string nested 'depth' levels deep, e.g. depth 3 -> "([{}])"
+std::string nested_string(long depth) {
+    const char open[] = {'(', '[', '{'};
+    const char close[] = {')', ']', '}'};
+    std::string s(2 * depth, ' ');
+    for (long i = 0; i < depth; ++ i) {
+        s[i] = open[i % 3];
+        s[2 * depth - 1 - i] = close[i % 3];
+    }
+    return s;
+}
+
+// Time one call of 'f' on 's', in nanoseconds
+template <class F>
+double time_ns(F f, const std::string& s, bool& result) {
+    auto start = std::chrono::steady_clock ::now();
+    result = f(s);
+    auto stop = std::chrono::steady_clock ::now();
+    return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count();
+}
+
+// Push/pop bursts on one ListStack must stop touching the heap once the pool
+// has grown to the largest burst
+bool check_steady_state() {
+    const int burst = 10000, rounds = 1000;
+    ListStack st;
+    for (int i = 0; i < burst; ++ i) st.push('(');
+    st.clear();
+    long warm = st.l.pool.slabAllocs;
+
+    auto start = std::chrono::steady_clock ::now();
+    for (int r = 0; r < rounds; ++ r) {
+        for (int i = 0; i < burst; ++ i) st.push('(');
+        for (int i = 0; i < burst / 2; ++ i) st.pop();
+        st.clear();
+    }
+    auto stop = std::chrono::steady_clock ::now();
+    double ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count();
+
+    long extra = st.l.pool.slabAllocs - warm;
+    std::cout << "Steady state: " << st.l.pool.nodeAllocs << " node allocations, "
+              << st.l.pool.slabAllocs << " slab allocations (" << extra << " after warmup), "
+              << ns / (1.5 * burst * rounds) << " ns/op\n";
+    return extra == 0;
+}
+
+// Push the brackets of s on st and return the number of heap buffers the
+// stack allocated
+template <class S>
+long count_allocs(S& st, const std::string& s) {
+    for (char c : s) {
+        if (c == '(' || c == '[' || c == '{') st.push(c);
+        else if ((c == ')' || c == ']' || c == '}') && st.size()) st.pop();
+    }
+    return st.heapAllocs;
+}
+
+// Time 'rounds' bursts of 'depth' pushes then pops, in ns per operation
+template <class S>
+double burst_ns(int depth, int rounds) {
+    S st;
+    auto start = std::chrono::steady_clock ::now();
+    for (int r = 0; r < rounds; ++ r) {
+        for (int i = 0; i < depth; ++ i) st.push('(' + (i & 1));
+        for (int i = 0; i < depth; ++ i) st.pop();
+    }
+    auto stop = std::chrono::steady_clock ::now();
+    return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / (2.0 * depth * rounds);
+}
+
+// Stack<char> must not allocate for inputs nesting less than its inline
+// capacity, and must hold move-only elements
+bool check_inline_storage() {
+    const char* shallow[] = {
+        "{{{{}}}[][]((())",
+        "(((((()))))){}{}{}[][][][[[]]]",
+        "{{{@23+6767}}}*<45>(a+b)[]",
+        "(((((a+b %%%%%####3422222222222)))))[]{}[]",
+        "{{dsafaswwwwwwwwwwwwwwwwwwwwwwwwwwwwww{{}}}[][]((***)())",
+    };
+    long allocs = 0;
+    for (const char* s : shallow) {
+        Stack<char> st;
+        allocs += count_allocs(st, s);
+    }
+    Stack<char> deep;
+    long deepAllocs = count_allocs(deep, nested_string(1000).substr(0, 1000));
+    std::cout << "Inline storage: " << allocs << " allocations on shallow inputs, "
+              << deepAllocs << " for depth 1000\n";
+
+    Stack<std::unique_ptr<int>, 2> owners;
+    for (int i = 0; i < 10; ++ i) owners.emplace(new int(i));
+    owners.push(std::unique_ptr<int>(new int(10)));
+    if (owners.size() != 11 || *owners.top() != 10) return false;
+    owners.pop();
+    if (*owners.top() != 9) return false;
+
+    std::cout << "depth\tStack<char> (ns/op)\tListStack (ns/op)\tstd::stack (ns/op)\n";
+    for (int depth : {8, 32, 64, 1024}) {
+        int rounds = 50000000 / depth;
+        std::cout << depth << "\t" << burst_ns<Stack<char>>(depth, rounds) << "\t" << burst_ns<ListStack>(depth, rounds)
+                  << "\t" << burst_ns<std::stack<char>>(depth, rounds) << "\n";
+    }
+    return allocs == 0 && deepAllocs > 0;
+}
+
+// Compare the scanners on mostly non-bracket text, after checking that every
+// scanner agrees with isValidString on random inputs
+bool compare_scanners() {
+    std::vector<std::pair<const char*, BracketFinder>> finders = {{"scalar", findBracketScalar}};
+#ifdef BRACKET_SCAN_X86
+    if (__builtin_cpu_supports("ssse3")) finders.push_back({"ssse3", findBracketSsse3});
+    if (__builtin_cpu_supports("avx2")) finders.push_back({"avx2", findBracketAvx2});
+#endif
+
+    const char alphabet[] = "()[]{}@%$a";
+    srand(1);
+    for (int t = 0; t < 20000; ++ t) {
+        std::string s(rand() % 80, ' ');
+        for (char& c : s) c = alphabet[rand() % 10];
+        bool expected = isValidString(s);
+        for (auto& f : finders) {
+            if (isValidStringSimd(s, f.second) != expected) {
+                std::cerr << f.first << " scanner disagrees on " << s << "\n";
+                return false;
+            }
+        }
+    }
+
+    std::string block = "@@@@@@@@@@@@@@@@@@@@@@@$$%%T$%$%$$%{}()%%%%%%%%%%%%%%%%%%%%%%%%%%%%";
+    std::string s;
+    while (s.size() < (64 << 20)) s += block;
+
+    bool result;
+    std::cout << "scanner\tns/char on " << (s.size() >> 20) << " MB of sparse brackets\n";
+    std::cout << "table (isValidString)\t" << time_ns(isValidString, s, result) / s.size() << "\n";
+    for (auto& f : finders) {
+        auto start = std::chrono::steady_clock ::now();
+        result = isValidStringSimd(s, f.second);
+        auto stop = std::chrono::steady_clock ::now();
+        double ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count();
+        std::cout << f.first << "\t" << ns / s.size() << "\n";
+    }
+    return true;
+}
+
+// Regression benchmark: the time per character must stay flat as the nesting
+// depth grows, for both our stack and std::stack
+int main() {
+
+    std::cout << "depth\tmy stack (ns/char)\tstd::stack (ns/char)\tratio\n";
+    for (long depth = 1000; depth <= 10000000; depth *= 10) {
+        std::string s = nested_string(depth);
+        bool mine, stl;
+        double t1 = time_ns(isValidString, s, mine);
+        double t2 = time_ns(isValidStringStl, s, stl);
+        if (!mine || !stl) {
+            std::cerr << "Unexpected result at depth " << depth << "\n";
+            return 1;
+        }
+        std::cout << depth << "\t" << t1 / s.size() << "\t" << t2 / s.size() << "\t" << t1 / t2 << "\n";
+    }
+
+    if (!check_steady_state()) {
+        std::cerr << "Node pool allocated from the heap in steady state\n";
+        return 1;
+    }
+
+    if (!compare_scanners()) return 1;
+
+    if (!check_inline_storage()) {
+        std::cerr << "Stack<char> inline storage check failed\n";
+        return 1;
+    }
+
+    return 0;
+
+}
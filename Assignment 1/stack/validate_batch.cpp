@@ -0,0 +1,196 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "bracket_batch.h"
+
+// Size of the blocks the input is read in
+#define BLOCK_SIZE (16 << 20)
+
+// Append the decimal digits of x to out
+void append_number(std::string& out, size_t x) {
+    char buf[24];
+    int i = sizeof(buf);
+    do {
+        buf[-- i] = '0' + x % 10;
+        x /= 10;
+    } while (x);
+    out.append(buf + i, sizeof(buf) - i);
+}
+
+// Validate every line of 'in' as a separate record and write the results to
+// 'out' (nothing if it is null), reading blocks of 'blockSize' bytes. Adds
+// the number of records and of bytes to 'index' and 'bytes'. Returns false
+// on a read error, with errno set.
+bool validate_stream(FILE* in, FILE* out, BatchValidator& pool, size_t blockSize, size_t& index, size_t& bytes) {
+    std::vector<char> buf(blockSize);
+    std::vector<Record> records;
+    std::vector<BatchResult> results;
+    std::string text;
+    size_t carry = 0;
+
+    while (true) {
+        size_t want = buf.size() - carry;
+        size_t n = fread(buf.data() + carry, 1, want, in);
+        if (n < want && ferror(in)) return false;
+        size_t len = carry + n;
+        bool eof = (n == 0);
+        if (len == 0) break;
+
+        // Split the block into lines; the unfinished last line is carried
+        // over to the next block
+        records.clear();
+        size_t begin = 0;
+        for (size_t i = 0; i < len; ++ i) {
+            if (buf[i] != '\n') continue;
+            size_t end = (i > begin && buf[i - 1] == '\r') ? i - 1 : i;
+            records.push_back({buf.data() + begin, end - begin});
+            begin = i + 1;
+        }
+        if (eof && begin < len) {
+            records.push_back({buf.data() + begin, len - begin});
+            begin = len;
+        }
+        if (records.empty() && begin == 0 && len == buf.size()) buf.resize(2 * buf.size());  // Line longer than the buffer
+
+        pool.validate(records, results);
+        bytes += begin;
+
+        if (out) {
+            text.clear();
+            for (size_t i = 0; i < results.size(); ++ i) {
+                append_number(text, index + i);
+                if (results[i].valid) text += " 1\n";
+                else {
+                    text += " 0 ";
+                    append_number(text, results[i].error);
+                    text += '\n';
+                }
+            }
+            fwrite(text.data(), 1, text.size(), out);
+        }
+        index += records.size();
+
+        carry = len - begin;
+        memmove(buf.data(), buf.data() + begin, carry);
+        if (eof) break;
+    }
+    return true;
+}
+
+// Run validate_stream on a small file, with a block shorter than some of its
+// lines, and check every output line against isValidString and the offset
+// found by BracketValidator. A directory must be reported as a read error.
+bool check_batch(BatchValidator& pool) {
+    const char* lines[] = {"()", "(]", "", "a{b}c\r", "((", "[(x)]{}", ")", "((((((((((()))))))))))", "{[}]"};
+    std::string fixture, expected;
+    size_t index = 0;
+    for (const char* line : lines) {
+        std::string s = line;
+        fixture += s + "\n";
+        if (!s.empty() && s.back() == '\r') s.pop_back();
+        BracketValidator v;
+        v.feed(s.data(), s.size());
+        bool valid = v.finish();
+        if (valid != isValidString(s)) {
+            std::cerr << "BracketValidator disagrees with isValidString on " << s << "\n";
+            return false;
+        }
+        append_number(expected, index ++);
+        if (valid) expected += " 1\n";
+        else {
+            expected += " 0 ";
+            append_number(expected, v.errorOffset());
+            expected += '\n';
+        }
+    }
+    fixture += "(no newline at the end";
+    append_number(expected, index);
+    expected += " 0 22\n";
+
+    FILE* in = tmpfile();
+    FILE* out = tmpfile();
+    if (!in || !out) {
+        std::cerr << "Cannot create a temporary file: " << strerror(errno) << "\n";
+        return false;
+    }
+    fwrite(fixture.data(), 1, fixture.size(), in);
+    rewind(in);
+    size_t records = 0, bytes = 0;
+    bool ok = validate_stream(in, out, pool, 8, records, bytes);
+    std::string got(expected.size() + 1, '\0');
+    rewind(out);
+    got.resize(fread(&got[0], 1, got.size(), out));
+    fclose(in);
+    fclose(out);
+    if (!ok || got != expected || records != index + 1 || bytes != fixture.size()) {
+        std::cerr << "validate_batch output is wrong on the fixture:\n" << got;
+        return false;
+    }
+
+    FILE* dir = fopen(".", "rb");
+    if (dir) {
+        records = bytes = 0;
+        ok = validate_stream(dir, nullptr, pool, 8, records, bytes);
+        fclose(dir);
+        if (ok) {
+            std::cerr << "Reading a directory is not reported as an error\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Usage: validate_batch [-t threads] [-q] [file]
+// Validates every line of 'file' (or of the standard input) as a separate
+// record and writes one line per record:
+//
+//     <record index> 1               if the record is valid
+//     <record index> 0 <offset>      otherwise, with the offset of the first
+//                                    mismatch inside the record
+//
+// -q skips the output. Throughput is reported on the standard error. A read
+// error stops the run with exit status 2.
+int main(int argc, char* argv[]) {
+
+    int threads = 0;
+    bool quiet = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++ i) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++ i]);
+        else if (strcmp(argv[i], "-q") == 0) quiet = true;
+        else path = argv[i];
+    }
+
+    BatchValidator pool(threads);
+    if (!check_batch(pool)) return 1;
+
+    FILE* in = path ? fopen(path, "rb") : stdin;
+    if (!in) {
+        std::cerr << "Cannot open " << path << ": " << strerror(errno) << "\n";
+        return 2;
+    }
+
+    size_t index = 0, bytes = 0;
+    auto start = std::chrono::steady_clock ::now();
+    bool ok = validate_stream(in, quiet ? nullptr : stdout, pool, BLOCK_SIZE, index, bytes);
+    int err = errno;    // Before fclose() can change it
+    auto stop = std::chrono::steady_clock ::now();
+    if (path) fclose(in);
+    if (!ok) {
+        std::cerr << "Error while reading " << (path ? path : "the standard input") << ": " << strerror(err) << "\n";
+        return 2;
+    }
+
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+    std::cerr << index << " records, " << bytes << " bytes in " << s << " s on " << pool.size() << " threads ("
+              << index / s << " records/s, " << bytes / s / 1e6 << " MB/s)\n";
+
+    return 0;
+
+}
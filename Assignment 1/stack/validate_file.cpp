@@ -0,0 +1,97 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bracket_validator.h"
+
+// Size of the pieces the input is fed to the validator in
+#define CHUNK_SIZE (1 << 20)
+
+// Validate a file with read() into one fixed-size buffer, retrying reads
+// interrupted by a signal
+bool validate_read(int fd, BracketValidator& v) {
+    std::vector<char> buf(CHUNK_SIZE);
+    ssize_t n;
+    while ((n = read(fd, buf.data(), buf.size())) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (!v.feed(buf.data(), n)) return true;
+    }
+    return true;
+}
+
+// Validate a file through mmap. Pages that have been validated are dropped
+// with MADV_DONTNEED so the resident size stays bounded on huge files.
+bool validate_mmap(int fd, BracketValidator& v) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    size_t size = st.st_size;
+    if (size == 0) return true;
+
+    char* p = (char*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return false;
+    madvise(p, size, MADV_SEQUENTIAL);
+
+    for (size_t off = 0; off < size; off += CHUNK_SIZE) {
+        size_t n = std::min((size_t)CHUNK_SIZE, size - off);
+        bool ok = v.feed(p + off, n);
+        madvise(p + off, n, MADV_DONTNEED);
+        if (!ok) break;
+    }
+    munmap(p, size);
+    return true;
+}
+
+// Usage: validate_file [--mmap | --read] <file>
+// Prints whether the file is valid and exits with 0 (valid), 1 (invalid)
+// or 2 (could not read the file)
+int main(int argc, char* argv[]) {
+
+    bool useMmap = true;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++ i) {
+        if (strcmp(argv[i], "--mmap") == 0) useMmap = true;
+        else if (strcmp(argv[i], "--read") == 0) useMmap = false;
+        else path = argv[i];
+    }
+    if (!path) {
+        std::cerr << "Usage: " << argv[0] << " [--mmap | --read] <file>\n";
+        return 2;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << path << ": " << strerror(errno) << "\n";
+        return 2;
+    }
+
+    BracketValidator v;
+    auto start = std::chrono::steady_clock ::now();
+    bool ok = useMmap ? validate_mmap(fd, v) : validate_read(fd, v);
+    int err = errno;    // Before close() can change it
+    close(fd);
+    if (!ok) {
+        std::cerr << "Error while reading " << path << ": " << strerror(err) << "\n";
+        return 2;
+    }
+    bool valid = v.finish();
+    auto stop = std::chrono::steady_clock ::now();
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+
+    if (valid) std::cout << path << ": valid\n";
+    else std::cout << path << ": invalid at byte " << v.errorOffset() << "\n";
+    std::cerr << v.offset << " bytes in " << s << " s (" << v.offset / s / 1e6 << " MB/s)\n";
+
+    return valid ? 0 : 1;
+
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../bench.h"
+#include "input_gen.h"
+#include "stack.h"
+#include "bracket_validator.h"
+#include "bracket_parallel.h"
+
+// The switch-based validator isValidString used before the grammar tables,
+// kept as the reference for the table-driven kernel
+bool isValidStringSwitch(const std::string& s) {
+    Stack<char> st;
+    for (char c : s) {
+        if (c == '(' || c == '[' || c == '{') st.push(c);
+        else if (c == ')' || c == ']' || c == '}') {
+            if (st.size() == 0) return false;
+            char topChar = st.top();
+            switch(topChar) {
+            case '(':
+                if (c == '}' || c == ']') return false;
+                break;
+            case '[':
+                if (c == '}' || c == ')') return false;
+                break;
+            case '{':
+                if (c == ')' || c == ']') return false;
+                break;
+            }
+            st.pop();
+        }
+    }
+    return (st.size() == 0);
+}
+
+// Grammar with <> as a fourth pair, "..." quotes and \ escapes
+typedef BracketGrammar<BracketPairs<'(', ')', '[', ']', '{', '}', '<', '>'>, '"', '\\'> CodeGrammar;
+
+// Grammar with guillemets, bytes above 0x7f, as a bracket pair
+typedef BracketGrammar<BracketPairs<'(', ')', '\xab', '\xbb'>> HighGrammar;
+
+// Check that the scanner, streaming and parallel paths agree with the plain
+// table-driven core of grammar G, error offset included
+template <class G>
+bool check_paths(const char* alphabet) {
+    std::vector<BracketFinder> finders = {findBracketScalar<G>, bracketFinder<G>()};
+    size_t letters = strlen(alphabet);
+    for (int t = 0; t < 20000; ++ t) {
+        std::string s(rand() % (t % 10 ? 40 : 400), ' ');
+        for (char& c : s) c = alphabet[rand() % letters];
+        GrammarCore<G, Stack<char>> core;
+        core.feed(s.data(), s.size());
+        bool valid = core.finish();
+
+        GrammarValidator<G> v(finders[t % 2]);
+        for (size_t i = 0; i < s.size(); ) {
+            size_t n = std::min<size_t>(1 + rand() % 8, s.size() - i);
+            v.feed(s.data() + i, n);
+            i += n;
+        }
+        size_t error = NO_BRACKET_ERROR;
+        bool parallel = isValidStringParallel<G>(s.data(), s.size(), 1 + t % 5, &error);
+        if (isValidStringSimd<G>(s, finders[t % 2]) != valid || v.finish() != valid || parallel != valid ||
+            (!valid && (v.errorOffset() != core.error || error != core.error))) {
+            std::cerr << "Grammar paths disagree on " << s << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check the table-driven kernel against the switch version, and the quote
+// and escape handling of CodeGrammar on a few inputs
+bool check_grammar() {
+    const char alphabet[] = "()[]{}<>a";
+    srand(1);
+    for (int t = 0; t < 20000; ++ t) {
+        std::string s(rand() % 40, ' ');
+        for (char& c : s) c = alphabet[rand() % 9];
+        if (isValidString(s) != isValidStringSwitch(s)) {
+            std::cerr << "Table-driven kernel disagrees on " << s << "\n";
+            return false;
+        }
+    }
+    struct { const char* s; bool valid; } cases[] = {
+        {"<a>(b)", true}, {"<a)", false}, {"\"(\" ()", true}, {"\"(", false},
+        {"\\( ()", true}, {"\"a\\\"(\"", true}, {"(\"]\")", true}, {"(>", false},
+    };
+    for (auto& c : cases) {
+        if (isValidGrammar<CodeGrammar, Stack<char>>(c.s, strlen(c.s)) != c.valid) {
+            std::cerr << "CodeGrammar is wrong on " << c.s << "\n";
+            return false;
+        }
+    }
+    if (!isValidGrammar<HighGrammar, Stack<char>>("\xab(\xab\xbb)\xbb", 6) ||
+        isValidGrammar<HighGrammar, Stack<char>>("\xab)", 2)) {
+        std::cerr << "HighGrammar is wrong on bytes above 0x7f\n";
+        return false;
+    }
+    return check_paths<DefaultGrammar>("()[]{}<>a\"\\") && check_paths<CodeGrammar>("()[]{}<>a\"\\") &&
+           check_paths<HighGrammar>("()\xab\xbb\xaa" "\xa0" "a");
+}
+
+// Usage: validator_bench [options]
+//   --length N      input length in bytes (default 1048576)
+//   --depth N       maximum nesting depth (default 64)
+//   --density F     fraction of bytes that are brackets (default 0.1)
+//   --invalid       generate an invalid input
+//   --seed N        generator seed (default 1)
+//   --warmup N      warmup calls (default 3)
+//   --reps N        samples per benchmark (default 30)
+//   --format F      table, csv or json (default table)
+int main(int argc, char* argv[]) {
+
+    GenOptions gen;
+    BenchOptions opt;
+    unsigned long seed = 1;
+    std::string format = "table";
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--length") gen.length = atol(val), ++ i;
+        else if (arg == "--depth") gen.depth = atoi(val), ++ i;
+        else if (arg == "--density") gen.density = atof(val), ++ i;
+        else if (arg == "--invalid") gen.valid = false;
+        else if (arg == "--seed") seed = atol(val), ++ i;
+        else if (arg == "--warmup") opt.warmup = atoi(val), ++ i;
+        else if (arg == "--reps") opt.reps = atoi(val), ++ i;
+        else if (arg == "--format") format = val, ++ i;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+
+    if (!check_grammar()) return 1;
+
+    std::string s = generateInput(gen, seed);
+    if (isValidString(s) != gen.valid) {
+        std::cerr << "Generator produced an input of the wrong validity\n";
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    results.push_back(runBench("switch kernel", [&]() { doNotOptimize(isValidStringSwitch(s)); }, opt, s.size()));
+    results.push_back(runBench("isValidString (table)", [&]() { doNotOptimize(isValidString(s)); }, opt, s.size()));
+    results.push_back(runBench("isValidStringStl", [&]() { doNotOptimize(isValidStringStl(s)); }, opt, s.size()));
+    results.push_back(runBench("CodeGrammar (table, quotes)", [&]() {
+        doNotOptimize(isValidGrammar<CodeGrammar, Stack<char>>(s.data(), s.size()));
+    }, opt, s.size()));
+    results.push_back(runBench("isValidStringSimd", [&]() { doNotOptimize(isValidStringSimd(s)); }, opt, s.size()));
+    results.push_back(runBench("isValidStringSimd<CodeGrammar>", [&]() {
+        doNotOptimize(isValidStringSimd<CodeGrammar>(s));
+    }, opt, s.size()));
+    results.push_back(runBench("BracketValidator", [&]() {
+        BracketValidator v;
+        v.feed(s.data(), s.size());
+        doNotOptimize(v.finish());
+    }, opt, s.size()));
+    results.push_back(runBench("isValidStringParallel", [&]() { doNotOptimize(isValidStringParallel(s)); }, opt, s.size()));
+
+    printResults(std::cout, results, format);
+
+    return 0;
+
+}
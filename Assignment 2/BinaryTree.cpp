@@ -1,6 +1,7 @@
 #include "BinaryTree.h"
 #include <queue>
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -75,28 +76,30 @@ using namespace std;
 /* Construction */
 /****************/
 
-template <class T>
-BinaryTree<T>::BinaryTree(T *elements, int n_elements)
+template <class T, class Storage>
+BinaryTree<T, Storage>::BinaryTree(T *elements, int n_elements)
 // Constructs this tree to have elements 'elements[1]', 'elements[2]' ...
 // as a complete binary tree (see above); 'element[0]' is ignored,
 // so the total number of cells if 'elements' is 'n_elements + 1'
 {
   root = NULL;
+  n_nodes = 0;
   init_complete(elements, n_elements);
 }
 
-template <class T>
-void BinaryTree<T>::init_complete(T *elements, int n_elements)
+template <class T, class Storage>
+void BinaryTree<T, Storage>::init_complete(T *elements, int n_elements)
 // Initializes this tree, regarding it as a complete binary tree
 // having elements 'elements[1]', 'elements[2]', ... (see above)
 {
   // call the helper function starting at the root index (1)
   root = init_complete(elements, n_elements, 1);
+  n_nodes = n_elements;
 }
 
-template <class T>
-BTNode<T> *BinaryTree<T>::init_complete(T *elements, int n_elements,
-                                        int index)
+template <class T, class Storage>
+BTNode<T> *BinaryTree<T, Storage>::init_complete(T *elements, int n_elements,
+                                                 int index)
 // Initializes this tree, regarding it as a complete binary tree,
 // starting at the array node at 'index'
 {
@@ -106,29 +109,29 @@ BTNode<T> *BinaryTree<T>::init_complete(T *elements, int n_elements,
 
   // create a new node, with left and right children assigned by
   // the recursive call
-  return new BTNode<T>(elements[index - 1],
-                       init_complete(elements, n_elements, 2 * index),
-                       init_complete(elements, n_elements, 2 * index + 1));
+  return nodes.make(elements[index - 1],
+                    init_complete(elements, n_elements, 2 * index),
+                    init_complete(elements, n_elements, 2 * index + 1));
 }
 
-template <class T>
+template <class T, class Storage>
 // Init a tree based on pre-order traversal
-BTNode<T> *BinaryTree<T>::init_complete_pre(T *elements, int n_elements, int &index, int max_height, int &extra)
+BTNode<T> *BinaryTree<T, Storage>::init_complete_pre(T *elements, int n_elements, int &index, int max_height, int &extra)
 {
   if (index >= n_elements)
     return NULL;
 
-  BTNode<T> *res = new BTNode<T>(elements[index++]);
+  BTNode<T> *res = nodes.make(elements[index++]);
   if (max_height == 1)
   {
     if (extra)
     {
-      res->left = new BTNode<T>(elements[index++]);
+      res->left = nodes.make(elements[index++]);
       --extra;
     }
     if (extra)
     {
-      res->right = new BTNode<T>(elements[index++]);
+      res->right = nodes.make(elements[index++]);
       --extra;
     }
   }
@@ -140,23 +143,23 @@ BTNode<T> *BinaryTree<T>::init_complete_pre(T *elements, int n_elements, int &in
   return res;
 }
 
-template <class T>
+template <class T, class Storage>
 // Init a tree based on post-order traversal
-BTNode<T> *BinaryTree<T>::init_complete_post(T *elements, int n_elements, int &index, int max_height, int &extra)
+BTNode<T> *BinaryTree<T, Storage>::init_complete_post(T *elements, int n_elements, int &index, int max_height, int &extra)
 {
   if (index >= n_elements)
     return NULL;
-  BTNode<T> *new_node = new BTNode<T>();
+  BTNode<T> *new_node = nodes.make();
   if (max_height == 1)
   {
     if (extra)
     {
-      new_node->left = new BTNode<T>(elements[index++]);
+      new_node->left = nodes.make(elements[index++]);
       --extra;
     }
     if (extra)
     {
-      new_node->right = new BTNode<T>(elements[index++]);
+      new_node->right = nodes.make(elements[index++]);
       --extra;
     }
     new_node->elem = elements[index++];
@@ -170,24 +173,24 @@ BTNode<T> *BinaryTree<T>::init_complete_post(T *elements, int n_elements, int &i
   return new_node;
 }
 
-template <class T>
+template <class T, class Storage>
 // Init a tree based on in-order traversal
-BTNode<T> *BinaryTree<T>::init_complete_in(T *elements, int n_elements, int &index, int max_height, int &extra)
+BTNode<T> *BinaryTree<T, Storage>::init_complete_in(T *elements, int n_elements, int &index, int max_height, int &extra)
 {
   if (index >= n_elements)
     return NULL;
-  BTNode<T> *new_node = new BTNode<T>();
+  BTNode<T> *new_node = nodes.make();
   if (max_height == 1)
   {
     if (extra)
     {
-      new_node->left = new BTNode<T>(elements[index++]);
+      new_node->left = nodes.make(elements[index++]);
       --extra;
     }
     new_node->elem = elements[index++];
     if (extra)
     {
-      new_node->right = new BTNode<T>(elements[index++]);
+      new_node->right = nodes.make(elements[index++]);
       --extra;
     }
   }
@@ -200,34 +203,67 @@ BTNode<T> *BinaryTree<T>::init_complete_in(T *elements, int n_elements, int &ind
   return new_node;
 }
 
-template <class T>
-BinaryTree<T>::BinaryTree(const BinaryTree &src)
+template <class T, class Storage>
+BinaryTree<T, Storage>::BinaryTree(const BinaryTree &src)
 // Construct a binary tree from a binary tree
 {
+  root = NULL;
+  n_nodes = 0;
 }
 
 /********************/
 /* Access and Tests */
 /********************/
 
-template <class T>
-bool BinaryTree<T>::is_empty() const
+template <class T, class Storage>
+bool BinaryTree<T, Storage>::is_empty() const
 // Check if the tree is empty or not
 {
   return root == NULL;
 }
 
-template <class T>
-int BinaryTree<T>::node_count(BTNode<T> *node) const
+template <class T, class Storage>
+int BinaryTree<T, Storage>::node_count(BTNode<T> *node) const
 {
   if (node == NULL)
     return 0;
   return 1 + node_count(node->left) + node_count(node->right);
 }
 
-template <class T>
+template <class T, class Storage>
+int BinaryTree<T, Storage>::node_count(TaskScheduler &sched) const
+// Count the nodes using every thread of 'sched'.  The top levels of the
+// tree are split into about 8 subtrees per thread, so that threads that
+// finish early can steal the remaining ones.
+{
+  int spawn_depth = 0;
+  while ((1 << spawn_depth) < 8 * sched.thread_count())
+    ++spawn_depth;
+  return node_count(root, sched, spawn_depth);
+}
+
+template <class T, class Storage>
+int BinaryTree<T, Storage>::node_count(BTNode<T> *node, TaskScheduler &sched,
+                                       int spawn_depth) const
+// Helper for the function above: spawn the left subtree while counting
+// the right one, down to 'spawn_depth' levels; below that, count serially
+{
+  if (node == NULL)
+    return 0;
+  if (spawn_depth == 0)
+    return node_count(node);
+  int left = 0;
+  TaskGroup group;
+  sched.spawn(group, [&]
+              { left = node_count(node->left, sched, spawn_depth - 1); });
+  int right = node_count(node->right, sched, spawn_depth - 1);
+  sched.sync(group);
+  return 1 + left + right;
+}
+
+template <class T, class Storage>
 // Get the height of the binary tree
-int BinaryTree<T>::height(BTNode<T> *node) const
+int BinaryTree<T, Storage>::height(BTNode<T> *node) const
 {
   if (!node)
     return 0;
@@ -251,8 +287,8 @@ int BinaryTree<T>::height(BTNode<T> *node) const
   return height;
 }
 
-template <class T>
-int BinaryTree<T>::complete_tree_height(int n_elements)
+template <class T, class Storage>
+int BinaryTree<T, Storage>::complete_tree_height(int n_elements)
 // Returns the height of a complete binary tree having 'n' nodes
 {
   int h = 0;
@@ -265,9 +301,9 @@ int BinaryTree<T>::complete_tree_height(int n_elements)
   return h;
 }
 
-template <class T>
+template <class T, class Storage>
 // Get the number of leaves of the binary tree
-int BinaryTree<T>::leaf_count(BTNode<T> *node) const
+int BinaryTree<T, Storage>::leaf_count(BTNode<T> *node) const
 {
   if (!node)
     return 0;
@@ -279,90 +315,154 @@ int BinaryTree<T>::leaf_count(BTNode<T> *node) const
 /********************/
 /* Mutators */
 /********************/
-template <class T>
-BTNode<T> *BinaryTree<T>::insert(T element, BTNode<T> *node)
-// Insert an element to the tree
+template <class T, class Storage>
+void BinaryTree<T, Storage>::insert(T element)
+// Insert an element at the next position of the complete tree, i.e.
+// index 'n_nodes + 1' in complete-tree order (see above)
 {
-  if (!node)
-    return new BTNode<T>(element);
-  queue<BTNode<T> *> q;
-  q.push(node);
-  while (!q.empty())
-  {
-    BTNode<T> *curr = q.front();
-    if (!curr->left)
-    {
-      curr->left = new BTNode<T>(element);
-      break;
-    }
-    q.push(curr->left);
-    if (!curr->right)
-    {
-      curr->right = new BTNode<T>(element);
-      cout << curr->right->elem;
-      break;
-    }
-    q.push(curr->right);
-    q.pop();
-  }
-  return node;
+  int index = n_nodes + 1;
+  BTNode<T> *new_node = nodes.make(element);
+  if (index == 1)
+    root = new_node;
+  else if (index % 2 == 0)
+    node_at(index / 2)->left = new_node;
+  else
+    node_at(index / 2)->right = new_node;
+  ++n_nodes;
 }
 
-template <class T>
-BTNode<T> *BinaryTree<T>::remove(T element, BTNode<T> *node)
-// Remove an element from the tree
+template <class T, class Storage>
+template <class Iter>
+void BinaryTree<T, Storage>::insert(Iter first, Iter last)
+// Insert the elements 'first' ... 'last' (exclusive) in this order, as
+// if one by one.  The parents of the new nodes are, in level order, the
+// existing nodes from index '(n_nodes + 1)/2' on and then the new nodes
+// themselves, so only the existing ones are looked up by their path.
 {
-  if (!node)
-    return NULL; // Stop the function if the current node is null
-
-  if (node->elem == element)
+  if (first == last)
+    return;
+  if (!root)
   {
-    if (!node->left)
-    {
-      BTNode<T> *tmp = node->right;
-      delete node;
-      return remove(element, tmp);
-    }
-    if (!node->right)
+    root = nodes.make(*first++);
+    n_nodes = 1;
+  }
+  int old_nodes = n_nodes;
+  int parent_index = (n_nodes + 1) / 2;
+  BTNode<T> *parent = node_at(parent_index);
+  queue<BTNode<T> *> new_nodes;
+  while (first != last)
+  {
+    BTNode<T> *new_node = nodes.make(*first++);
+    new_nodes.push(new_node);
+    if (!parent->left)
+      parent->left = new_node;
+    else
     {
-      BTNode<T> *tmp = node->left;
-      delete node;
-      return remove(element, tmp);
+      parent->right = new_node;
+      ++parent_index;
+      if (parent_index <= old_nodes)
+        parent = node_at(parent_index);
+      else
+      {
+        parent = new_nodes.front();
+        new_nodes.pop();
+      }
     }
-    node->left = remove(element, node->left); // Remove all nodes having value = element on the left subtree
-
-    BTNode<T> *tmp = node->right, *prev = NULL;
-    for (; tmp->left; prev = tmp, tmp = tmp->left)
-      ;
+    ++n_nodes;
+  }
+}
 
-    node->elem = tmp->elem; // Set current node value to the value of the leftmost node on the right subtree
+template <class T, class Storage>
+BTNode<T> *BinaryTree<T, Storage>::node_at(int index) const
+// PRE: 1 <= index <= n_nodes
+// Find the node at 'index' in complete-tree order.  Below the leading 1,
+// the binary digits of 'index' spell the path from the root, most
+// significant first:  0 goes left, 1 goes right.
+{
+  int bit = 1;
+  while ((bit << 1) <= index)
+    bit <<= 1;
+  BTNode<T> *node = root;
+  for (bit >>= 1; bit; bit >>= 1)
+    node = (index & bit) ? node->right : node->left;
+  return node;
+}
 
-    // Delete the leftmost node on the right subtree
-    if (prev == NULL)
-      node->right = tmp->right;
-    else
-      prev->left = tmp->right;
-    delete tmp;
+template <class T, class Storage>
+void BinaryTree<T, Storage>::remove(T element)
+// Remove every node containing 'element'
+{
+  remove_matching([&element](const T &x)
+                  { return x == element; });
+}
 
-    node->right = remove(element, node->right); // Remove all nodes having value = element on the right subtree
+template <class T, class Storage>
+void BinaryTree<T, Storage>::remove_all(const vector<T> &elements)
+// Remove every node whose element is one of 'elements' (which need
+// 'operator<'), in a single pass over the tree
+{
+  vector<T> sorted(elements);
+  sort(sorted.begin(), sorted.end());
+  remove_matching([&sorted](const T &x)
+                  { return binary_search(sorted.begin(), sorted.end(), x); });
+}
 
-    return node;
-  }
+template <class T, class Storage>
+template <class Match>
+void BinaryTree<T, Storage>::remove_matching(Match match)
+// Remove every node whose element satisfies 'match' and keep the tree
+// complete:  each victim takes the element of the last node in
+// complete-tree order, and that node is unlinked.  Going through the
+// victims from the highest index down, every element moved is one that
+// stays.
+{
+  vector<pair<int, BTNode<T> *> > found;
+  find_matching(match, root, 1, found);
+  sort(found.begin(), found.end());
+  for (int k = (int)found.size() - 1; k >= 0; --k)
+    remove_at(found[k].second, found[k].first);
+}
 
-  // If the current node's value does not equal "element", recursively call the function on the left and right subtree
-  node->left = remove(element, node->left);
-  node->right = remove(element, node->right);
+template <class T, class Storage>
+template <class Match>
+void BinaryTree<T, Storage>::find_matching(Match &match, BTNode<T> *node, int index,
+                                           vector<pair<int, BTNode<T> *> > &found) const
+// Collect the nodes under 'node' (at 'index') whose element satisfies
+// 'match', with their indices in complete-tree order
+{
+  if (!node)
+    return;
+  if (match(node->elem))
+    found.push_back(make_pair(index, node));
+  find_matching(match, node->left, 2 * index, found);
+  find_matching(match, node->right, 2 * index + 1, found);
+}
 
-  return node; // Return the current node
+template <class T, class Storage>
+void BinaryTree<T, Storage>::remove_at(BTNode<T> *node, int index)
+// Remove the element of 'node', at 'index', by moving the last element
+// into it and unlinking the last node
+{
+  BTNode<T> *last = node_at(n_nodes);
+  if (index != n_nodes)
+    node->elem = last->elem;
+  if (n_nodes == 1)
+    root = NULL;
+  else if (n_nodes % 2 == 0)
+    node_at(n_nodes / 2)->left = NULL;
+  else
+    node_at(n_nodes / 2)->right = NULL;
+  nodes.destroy(last);
+  --n_nodes;
 }
 
-template <class T>
-BTNode<T> *BinaryTree<T>::shuffle(queue<BTNode<T> *> &q, BTNode<T> *node)
+template <class T, class Storage>
+BTNode<T> *BinaryTree<T, Storage>::shuffle(queue<BTNode<T> *> &q, BTNode<T> *node)
 // Shuffle the nodes to make the tree complete
 {
   if (!node)
     return NULL;
-  BTNode<T> *new_node = new BTNode<T>(node->elem);
+  BTNode<T> *new_node = nodes.make(node->elem);
   if (!q.empty() && q.front()->left && q.front()->right)
     q.pop();
   if (!q.empty())
@@ -375,12 +475,12 @@ BTNode<T> *BinaryTree<T>::shuffle(queue<BTNode<T> *> &q, BTNode<T> *node)
   q.push(new_node);
   shuffle(q, node->left);
   shuffle(q, node->right);
-  delete node;
+  nodes.destroy(node);
   return new_node;
 }
 
-template <class T>
-void BinaryTree<T>::empty(BTNode<T> *node)
+template <class T, class Storage>
+void BinaryTree<T, Storage>::empty(BTNode<T> *node)
 // Empty the binary tree
 {
   if (!node)
@@ -388,7 +488,7 @@ void BinaryTree<T>::empty(BTNode<T> *node)
   BTNode<T> *tmp1 = node->left, *tmp2 = node->right;
   node->left = NULL;
   node->right = NULL;
-  delete node;
+  nodes.destroy(node);
   empty(tmp1);
   empty(tmp2);
 }
@@ -397,8 +497,8 @@ void BinaryTree<T>::empty(BTNode<T> *node)
 /* Traversal */
 /*************/
 
-template <class T>
-void BinaryTree<T>::preorder(void (*f)(const T &), BTNode<T> *node) const
+template <class T, class Storage>
+void BinaryTree<T, Storage>::preorder(void (*f)(const T &), BTNode<T> *node) const
 {
   if (!node)
     return;
@@ -407,8 +507,8 @@ void BinaryTree<T>::preorder(void (*f)(const T &), BTNode<T> *node) const
   preorder(f, node->right);
 }
 
-template <class T>
-void BinaryTree<T>::inorder(void (*f)(const T &), BTNode<T> *node) const
+template <class T, class Storage>
+void BinaryTree<T, Storage>::inorder(void (*f)(const T &), BTNode<T> *node) const
 {
   if (!node)
     return;
@@ -417,22 +517,119 @@ void BinaryTree<T>::inorder(void (*f)(const T &), BTNode<T> *node) const
   inorder(f, node->right);
 }
 
-template <class T>
-void BinaryTree<T>::postorder(void (*f)(const T &), BTNode<T> *node) const
+template <class T, class Storage>
+void BinaryTree<T, Storage>::postorder(void (*f)(const T &), BTNode<T> *node) const
 {
   if (!node)
     return;
   postorder(f, node->left);
-  f(node->elem);
   postorder(f, node->right);
+  f(node->elem);
+}
+
+template <class T, class Storage>
+template <class F>
+bool BinaryTree<T, Storage>::for_each_preorder(F &&f) const
+// Call 'f' on every element in pre-order, without recursion, until it
+// returns false (see 'visit_element').  Returns false if it was stopped.
+{
+  BTNode<T> *fixed[traversal_stack_size], **stack = fixed;
+  vector<BTNode<T> *> more;
+  int top = 0, capacity = traversal_stack_size;
+  if (root)
+    stack[top++] = root;
+  while (top > 0)
+  {
+    BTNode<T> *node = stack[--top];
+    if (!visit_element(f, node->elem, 0))
+      return false;
+    if (top + 2 > capacity)
+    {
+      stack = grow_traversal_stack(stack, top, capacity, more);
+      capacity *= 2;
+    }
+    // the right subtree is pushed first so that the left one comes first
+    if (node->right)
+      stack[top++] = node->right;
+    if (node->left)
+      stack[top++] = node->left;
+  }
+  return true;
+}
+
+template <class T, class Storage>
+template <class F>
+bool BinaryTree<T, Storage>::for_each_inorder(F &&f) const
+// Same as above, in in-order
+{
+  BTNode<T> *fixed[traversal_stack_size], **stack = fixed;
+  vector<BTNode<T> *> more;
+  int top = 0, capacity = traversal_stack_size;
+  BTNode<T> *node = root;
+  while (node || top > 0)
+  {
+    // go down to the leftmost node, remembering the way back up
+    for (; node; node = node->left)
+    {
+      if (top == capacity)
+      {
+        stack = grow_traversal_stack(stack, top, capacity, more);
+        capacity *= 2;
+      }
+      stack[top++] = node;
+    }
+    node = stack[--top];
+    if (!visit_element(f, node->elem, 0))
+      return false;
+    node = node->right;
+  }
+  return true;
+}
+
+template <class T, class Storage>
+template <class F>
+bool BinaryTree<T, Storage>::for_each_postorder(F &&f) const
+// Same as above, in post-order.  Every node on the stack has its left
+// subtree done; it is visited once its right subtree is done too, which
+// the flag next to it tells.
+{
+  typedef pair<BTNode<T> *, bool> Entry;
+  Entry fixed[traversal_stack_size], *stack = fixed;
+  vector<Entry> more;
+  int top = 0, capacity = traversal_stack_size;
+  BTNode<T> *node = root;
+  while (true)
+  {
+    for (; node; node = node->left)
+    {
+      if (top == capacity)
+      {
+        stack = grow_traversal_stack(stack, top, capacity, more);
+        capacity *= 2;
+      }
+      stack[top++] = Entry(node, false);
+    }
+    if (top == 0)
+      return true;
+    Entry &entry = stack[top - 1];
+    if (!entry.second && entry.first->right)
+    {
+      entry.second = true;
+      node = entry.first->right;
+      continue;
+    }
+    if (!visit_element(f, entry.first->elem, 0))
+      return false;
+    --top;
+  }
 }
 
 /************************/
 /* Conversion to Arrays */
 /************************/
 
-template <class T>
-int BinaryTree<T>::to_flat_array(T *elements, int max) const
+template <class T, class Storage>
+int BinaryTree<T, Storage>::to_flat_array(T *elements, int max) const
 // PRE: This is a complete binary tree
 // Copies the elements contained in the nodes of this tree to
 // 'elements' in complete-tree order (see above).  At most
@@ -446,9 +643,9 @@ int BinaryTree<T>::to_flat_array(T *elements, int max) const
   return to_flat_array(elements, max, root, 1, max_index);
 }
 
-template <class T>
-int BinaryTree<T>::to_flat_array(T *elements, int max, BTNode<T> *node,
-                                 int index, int &max_index) const
+template <class T, class Storage>
+int BinaryTree<T, Storage>::to_flat_array(T *elements, int max, BTNode<T> *node,
+                                          int index, int &max_index) const
 // PRE: this is a complete binary tree
 // Helper function for the 'to_flat_array' function above
 // 'node' is the current node, 'index' is the index of the node
@@ -482,8 +679,8 @@ int BinaryTree<T>::to_flat_array(T *elements, int max, BTNode<T> *node,
 /* Input/Output Operators */
 /**************************/
 
-template <class T>
-ostream &operator<<(ostream &out, const BinaryTree<T> &src)
+template <class T, class Storage>
+ostream &operator<<(ostream &out, const BinaryTree<T, Storage> &src)
 // Writes the elements contained in the nodes of this tree,
 // by way of an inorder traversal
 {
@@ -519,8 +716,8 @@ static const double node_sep = 30;
 static const double node_box_margin = 6;
 static const double node_box_r = 6;
 
-template <class T>
-void BinaryTree<T>::display(PDF *pdf, const string &annotation) const
+template <class T, class Storage>
+void BinaryTree<T, Storage>::display(PDF *pdf, const string &annotation) const
 {
   double scale = 1;
 
@@ -547,9 +744,9 @@ void BinaryTree<T>::display(PDF *pdf, const string &annotation) const
   display(pdf, root, h - 1, x, y, scale);
 }
 
-template <class T>
-void BinaryTree<T>::display(PDF *pdf, BTNode<T> *node, int leaf_dist,
-                            double x, double y, double scale) const
+template <class T, class Storage>
+void BinaryTree<T, Storage>::display(PDF *pdf, BTNode<T> *node, int leaf_dist,
+                                     double x, double y, double scale) const
 {
   // don't draw a NULL node
   if (node == NULL)
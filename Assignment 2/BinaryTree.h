@@ -4,8 +4,13 @@
 #include <sstream>
 #include <queue>
 #include <cmath>
+#include <vector>
+#include <utility>
+#include <type_traits>
 
 #include "PDF.h" // for the PDF display
+#include "TaskScheduler.h" // for the parallel traversals
+#include "NodeArena.h"     // for the node allocation policies
 
 using namespace std;
 
@@ -45,14 +50,79 @@ struct BTNode
 /* A 'BinaryTree' class implements a basic binary tree.  It serves
  * as a superclass for more specific types of binary trees, such as
  * a binary search tree.
+ *
+ * 'Storage' selects how the nodes are kept:
+ *
+ *   LinkedStorage<Alloc>
+ *                   one 'BTNode' per element, made by the allocation
+ *                   policy 'Alloc' (see 'NodeArena.h'); the default,
+ *                   'LinkedStorage<>', takes them from a per-tree arena
+ *   FlatStorage     the elements of a complete tree in one array, in the
+ *                   complete-tree order described in 'BinaryTree.cpp'
+ *                   (see 'BinaryTreeFlat.h')
+ *
+ * Both have the same public interface.
  */
 
-template <class T>
+/* The visitor traversals ('for_each_preorder' ...) call a function or
+ * lambda on every element.  If it returns a bool, 'false' stops the
+ * traversal; if it returns nothing, the traversal always goes on. */
+
+template <class F, class T>
+inline auto visit_element(F &f, const T &element, int)
+    -> typename enable_if<is_void<decltype(f(element))>::value, bool>::type
+{
+  f(element);
+  return true;
+}
+
+template <class F, class T>
+inline bool visit_element(F &f, const T &element, ...)
+{
+  return f(element);
+}
+
+/* The visitor traversals keep their pending nodes in a fixed array
+ * instead of recursing.  A complete tree with an 'int' node count is
+ * less than 32 levels high and never needs more than this; the trees of
+ * subclasses (a binary search tree, say) need not be complete, so the
+ * linked traversals move their stack to a 'vector' past this depth
+ * (see 'grow_traversal_stack'). */
+static const int traversal_stack_size = 64;
+
+/* Called by a traversal whose stack of 'capacity' entries is full:
+ * returns a stack twice that size, kept in 'more', holding its first
+ * 'top' entries.  Only deep, unbalanced trees get here. */
+template <class E>
+E *grow_traversal_stack(const E *stack, int top, int capacity, vector<E> &more)
+{
+  vector<E> grown(stack, stack + top);
+  grown.resize(2 * capacity);
+  more.swap(grown);
+  return more.data();
+}
+
+template <template <class> class Alloc = NodeArena>
+struct LinkedStorage
+{
+  template <class Node>
+  using allocator = Alloc<Node>;
+};
+
+struct FlatStorage
+{
+};
+
+template <class T, class Storage = LinkedStorage<> >
 class BinaryTree
 {
 public:
   /* Construction */
-  BinaryTree() { root = NULL; }
+  BinaryTree()
+  {
+    root = NULL;
+    n_nodes = 0;
+  }
   BinaryTree(T *elements, int n_elements);
   BinaryTree(const BinaryTree &src);
   ~BinaryTree() { empty_this(); }
@@ -61,13 +131,19 @@ public:
   bool is_empty() const;
   int height() const { return height(root); }
   int node_count() const { return node_count(root); }
+  int node_count(TaskScheduler &sched) const;
   int leaf_count() const { return leaf_count(root); }
 
   /* Mutators, and other Initialization */
   bool empty_this()
   {
-    empty(root);
+    // nodes that need no destructor are dropped with the whole arena
+    if (Allocator::can_reset && is_trivially_destructible<BTNode<T> >::value)
+      nodes.reset();
+    else
+      empty(root);
     root = NULL;
+    n_nodes = 0;
     return true;
   }
   void init_complete(T *elements, int n_elements);
@@ -78,6 +154,7 @@ public:
     int index = 0;
 
     root = init_complete_pre(elements, n_elements, index, tree_height - 1, extra);
+    n_nodes = n_elements;
   }
   void init_complete_post(T *elements, int n_elements)
   {
@@ -86,6 +163,7 @@ public:
     int index = 0;
 
     root = init_complete_post(elements, n_elements, index, tree_height - 1, extra);
+    n_nodes = n_elements;
   }
   void init_complete_in(T *elements, int n_elements)
   {
@@ -94,6 +172,7 @@ public:
     int index = 0;
 
     root = init_complete_in(elements, n_elements, index, tree_height - 1, extra);
+    n_nodes = n_elements;
   }
   void shuffle()
   {
@@ -101,17 +180,22 @@ public:
     root = shuffle(q, root);
   }
   int to_flat_array(T *elements, int max) const;
-  void insert(T element) { root = insert(element, root); };
-  void remove(T element)
-  {
-    root = remove(element, root);
-    shuffle();
-  };
+  void insert(T element);
+  template <class Iter>
+  void insert(Iter first, Iter last);
+  void remove(T element);
+  void remove_all(const vector<T> &elements);
 
   /* Traversal */
   void preorder(void (*f)(const T &)) const { return preorder(f, root); }
   void inorder(void (*f)(const T &)) const { return inorder(f, root); }
   void postorder(void (*f)(const T &)) const { return postorder(f, root); }
+  template <class F>
+  bool for_each_preorder(F &&f) const;
+  template <class F>
+  bool for_each_inorder(F &&f) const;
+  template <class F>
+  bool for_each_postorder(F &&f) const;
 
   /* Operators */
   // bool operator==(const BinaryTree &src) const;
@@ -119,14 +203,18 @@ public:
   // BinaryTree &operator=(const BinaryTree &src) const;
 
   /* Input/Output */
-  template <class S>
-  friend ostream &operator<<(ostream &out, const BinaryTree<S> &src);
+  template <class S, class SStorage>
+  friend ostream &operator<<(ostream &out, const BinaryTree<S, SStorage> &src);
 
   /* Display */
   void display(PDF *pdf, const string &annotation = "") const;
 
 protected:
+  typedef typename Storage::template allocator<BTNode<T> > Allocator;
+
   BTNode<T> *root; // Root node (NULL if the tree is empty)
+  int n_nodes;     // Number of nodes; the tree is always complete
+  Allocator nodes; // Makes and destroys the nodes
 
   /* "Helper" functions for the basic operations */
   // BTNode<T> *clone(BTNode<T> *node);
@@ -134,6 +222,7 @@ protected:
   int height(BTNode<T> *node) const;
   // int balance_factor( BTNode<T>* node ) const;
   int node_count(BTNode<T> *node) const;
+  int node_count(BTNode<T> *node, TaskScheduler &sched, int spawn_depth) const;
   int leaf_count(BTNode<T> *node) const;
 
   void preorder(void (*f)(const T &), BTNode<T> *node) const;
@@ -141,8 +230,13 @@ protected:
   void postorder(void (*f)(const T &), BTNode<T> *node) const;
 
   void empty(BTNode<T> *node); // To empty the tree
-  BTNode<T> *insert(T element, BTNode<T> *node);
-  BTNode<T> *remove(T element, BTNode<T> *node);
+  BTNode<T> *node_at(int index) const;
+  template <class Match>
+  void remove_matching(Match match);
+  template <class Match>
+  void find_matching(Match &match, BTNode<T> *node, int index,
+                     vector<pair<int, BTNode<T> *> > &found) const;
+  void remove_at(BTNode<T> *node, int index);
   BTNode<T> *shuffle(queue<BTNode<T> *> &q, BTNode<T> *node);
 
   BTNode<T> *init_complete(T *elements, int n_elements, int index);
@@ -162,5 +256,6 @@ protected:
 };
 
 #include "BinaryTree.cpp"
+#include "BinaryTreeFlat.h"
 
 #endif
@@ -0,0 +1,343 @@
+#include "BinaryTreeFlat.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+
+using namespace std;
+
+/****************************************************************************/
+/***             Implementation of BinaryTree<T, FlatStorage>		  ***/
+/****************************************************************************/
+
+/****************/
+/* Construction */
+/****************/
+
+template <class T>
+BinaryTree<T, FlatStorage>::BinaryTree(T *elements, int n_elements)
+    : elems(1)
+// Same as the linked tree: 'elements[0]' ... 'elements[n_elements - 1]'
+// in complete-tree order
+{
+  init_complete(elements, n_elements);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::init_complete(T *elements, int n_elements)
+// The array is already in complete-tree order, so this is a copy
+{
+  elems.resize(1);
+  elems.insert(elems.end(), elements, elements + n_elements);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::init_complete_pre(T *elements, int n_elements)
+// Build the complete tree whose pre-order traversal is 'elements'
+{
+  elems.assign(n_elements + 1, T());
+  int index = 0;
+  fill_pre(elements, index, 1);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::init_complete_post(T *elements, int n_elements)
+// Build the complete tree whose post-order traversal is 'elements'
+{
+  elems.assign(n_elements + 1, T());
+  int index = 0;
+  fill_post(elements, index, 1);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::init_complete_in(T *elements, int n_elements)
+// Build the complete tree whose in-order traversal is 'elements'
+{
+  elems.assign(n_elements + 1, T());
+  int index = 0;
+  fill_in(elements, index, 1);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::fill_pre(T *elements, int &index, int i)
+// Store the next elements at node 'i' and below, in pre-order
+{
+  if (i > size())
+    return;
+  elems[i] = elements[index++];
+  fill_pre(elements, index, 2 * i);
+  fill_pre(elements, index, 2 * i + 1);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::fill_post(T *elements, int &index, int i)
+{
+  if (i > size())
+    return;
+  fill_post(elements, index, 2 * i);
+  fill_post(elements, index, 2 * i + 1);
+  elems[i] = elements[index++];
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::fill_in(T *elements, int &index, int i)
+{
+  if (i > size())
+    return;
+  fill_in(elements, index, 2 * i);
+  elems[i] = elements[index++];
+  fill_in(elements, index, 2 * i + 1);
+}
+
+/********************/
+/* Access and Tests */
+/********************/
+
+template <class T>
+int BinaryTree<T, FlatStorage>::height() const
+// Same convention as the linked tree: the number of levels minus one,
+// and 0 for an empty tree
+{
+  int h = 0;
+  for (int n = size(); n > 1; n /= 2)
+    ++h;
+  return h;
+}
+
+/************/
+/* Mutators */
+/************/
+
+template <class T>
+void BinaryTree<T, FlatStorage>::remove(T element)
+// Remove every element equal to 'element'
+{
+  remove_matching([&element](const T &x)
+                  { return x == element; });
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::remove_all(const vector<T> &elements)
+// Remove every element that is one of 'elements' (which need 'operator<')
+{
+  vector<T> sorted(elements);
+  sort(sorted.begin(), sorted.end());
+  remove_matching([&sorted](const T &x)
+                  { return binary_search(sorted.begin(), sorted.end(), x); });
+}
+
+template <class T>
+template <class Match>
+void BinaryTree<T, FlatStorage>::remove_matching(Match match)
+// Same order as the linked tree:  from the last index down, a matching
+// element is replaced by the last one, which never matches by then
+{
+  for (int i = size(); i >= 1; --i)
+    if (match(elems[i]))
+    {
+      elems[i] = elems[size()];
+      elems.pop_back();
+    }
+}
+
+/*************/
+/* Traversal */
+/*************/
+
+template <class T>
+void BinaryTree<T, FlatStorage>::preorder(void (*f)(const T &), int i) const
+{
+  if (i > size())
+    return;
+  f(elems[i]);
+  preorder(f, 2 * i);
+  preorder(f, 2 * i + 1);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::inorder(void (*f)(const T &), int i) const
+{
+  if (i > size())
+    return;
+  inorder(f, 2 * i);
+  f(elems[i]);
+  inorder(f, 2 * i + 1);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::postorder(void (*f)(const T &), int i) const
+{
+  if (i > size())
+    return;
+  postorder(f, 2 * i);
+  postorder(f, 2 * i + 1);
+  f(elems[i]);
+}
+
+template <class T>
+template <class F>
+bool BinaryTree<T, FlatStorage>::for_each_preorder(F &&f) const
+// Call 'f' on every element in pre-order, without recursion, until it
+// returns false (see 'visit_element' in 'BinaryTree.h').  Returns false
+// if it was stopped.  A flat tree is always complete, so the stack never
+// holds more than two entries per level.
+{
+  int stack[traversal_stack_size];
+  int top = 0, n = size();
+  if (n > 0)
+  {
+    assert(top < traversal_stack_size);
+    stack[top++] = 1;
+  }
+  while (top > 0)
+  {
+    int i = stack[--top];
+    if (!visit_element(f, elems[i], 0))
+      return false;
+    if (2 * i + 1 <= n)
+    {
+      assert(top < traversal_stack_size);
+      stack[top++] = 2 * i + 1;
+    }
+    if (2 * i <= n)
+    {
+      assert(top < traversal_stack_size);
+      stack[top++] = 2 * i;
+    }
+  }
+  return true;
+}
+
+template <class T>
+template <class F>
+bool BinaryTree<T, FlatStorage>::for_each_inorder(F &&f) const
+// Same as above, in in-order
+{
+  int stack[traversal_stack_size];
+  int top = 0, n = size(), i = 1;
+  while (i <= n || top > 0)
+  {
+    for (; i <= n; i *= 2)
+    {
+      assert(top < traversal_stack_size);
+      stack[top++] = i;
+    }
+    i = stack[--top];
+    if (!visit_element(f, elems[i], 0))
+      return false;
+    i = 2 * i + 1;
+  }
+  return true;
+}
+
+template <class T>
+template <class F>
+bool BinaryTree<T, FlatStorage>::for_each_postorder(F &&f) const
+// Same as above, in post-order
+{
+  int stack[traversal_stack_size];
+  int top = 0, n = size(), i = 1, last = 0;
+  while (i <= n || top > 0)
+  {
+    for (; i <= n; i *= 2)
+    {
+      assert(top < traversal_stack_size);
+      stack[top++] = i;
+    }
+    int peek = stack[top - 1];
+    if (2 * peek + 1 <= n && 2 * peek + 1 != last)
+      i = 2 * peek + 1;
+    else
+    {
+      if (!visit_element(f, elems[peek], 0))
+        return false;
+      last = peek;
+      --top;
+      i = n + 1; // nothing to descend into
+    }
+  }
+  return true;
+}
+
+/************************/
+/* Conversion to Arrays */
+/************************/
+
+template <class T>
+int BinaryTree<T, FlatStorage>::to_flat_array(T *elements, int max) const
+// Same contract as the linked tree: copies the elements with index below
+// 'max' to 'elements[1]' ... and returns the number of nodes
+{
+  for (int i = 1; i <= size() && i < max; ++i)
+    elements[i] = elems[i];
+  return size();
+}
+
+/**************************/
+/* Input/Output Operators */
+/**************************/
+
+template <class T>
+ostream &operator<<(ostream &out, const BinaryTree<T, FlatStorage> &src)
+// Writes the elements by way of an inorder traversal
+{
+  src.write(out, 1);
+  return out;
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::write(ostream &out, int i) const
+// Helper for the 'operator<<' above
+{
+  if (i > size())
+    return;
+  write(out, 2 * i);
+  out << elems[i] << " ";
+  write(out, 2 * i + 1);
+}
+
+/***********/
+/* Display */
+/***********/
+
+template <class T>
+void BinaryTree<T, FlatStorage>::display(PDF *pdf, const string &annotation) const
+// Draws the tree exactly as the linked tree does
+{
+  double scale = 1;
+  int h = height();
+  if (h >= 4)
+    scale = 16.0 / double(1 << h);
+
+  pdf->new_page(annotation.c_str());
+  double x = pdf->get_width() / 2;
+  double y = pdf->get_height() - 72;
+
+  pdf->selectfont(Helvetica, font_scale * scale);
+  pdf->setcolor_nonstroke(PDFColor(0.75));
+  pdf->setlinewidth(scale);
+
+  if (!is_empty())
+    display(pdf, 1, h - 1, x, y, scale);
+}
+
+template <class T>
+void BinaryTree<T, FlatStorage>::display(PDF *pdf, int i, int leaf_dist,
+                                         double x, double y, double scale) const
+{
+  // draw the lines to the children first, so that the boxes cover them
+  for (int c = 2 * i; c <= 2 * i + 1 && c <= size(); ++c)
+  {
+    double x_child = x + (c == 2 * i ? -1 : 1) * (1 << leaf_dist) * node_sep * scale / 2;
+    double y_child = y - level_sep * scale;
+    pdf->moveto(x, y);
+    pdf->lineto(x_child, y_child);
+    pdf->stroke();
+    display(pdf, c, leaf_dist - 1, x_child, y_child, scale);
+  }
+
+  ostringstream str;
+  str << elems[i];
+  pdf->text_box(str.str().c_str(), x, y,
+                scale * node_box_margin, scale * node_box_r,
+                0, scale * font_scale);
+}
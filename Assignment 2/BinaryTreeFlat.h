@@ -0,0 +1,102 @@
+#ifndef __BinaryTreeFlat_H
+#define __BinaryTreeFlat_H
+
+#include <vector>
+
+#include "BinaryTree.h"
+
+using namespace std;
+
+/****************************************************************************
+ *
+ * CLASS:  BinaryTree<T, FlatStorage>
+ *
+ ****************************************************************************/
+
+/* A complete binary tree kept in a flat array, in the complete-tree order
+ * described in 'BinaryTree.cpp': the root at index 1, the children of
+ * node i at 2*i and 2*i + 1, and cell 0 unused.  There are no nodes and no
+ * pointers, so a tree of n elements takes n + 1 cells, and walking it
+ * touches consecutive memory.
+ *
+ * The tree is always complete:  'insert' appends in the next free
+ * position, and 'remove' fills each gap with the last element, as the
+ * linked tree does.  'shuffle' has nothing left to do.
+ */
+
+template <class T>
+class BinaryTree<T, FlatStorage>
+{
+public:
+  /* Construction */
+  BinaryTree() : elems(1) {}
+  BinaryTree(T *elements, int n_elements);
+
+  /* Access and Tests */
+  bool is_empty() const { return size() == 0; }
+  int height() const;
+  int node_count() const { return size(); }
+  int node_count(TaskScheduler &) const { return size(); }
+  int leaf_count() const { return (size() + 1) / 2; }
+
+  /* Mutators, and other Initialization */
+  bool empty_this()
+  {
+    elems.resize(1);
+    return true;
+  }
+  void init_complete(T *elements, int n_elements);
+  void init_complete_pre(T *elements, int n_elements);
+  void init_complete_post(T *elements, int n_elements);
+  void init_complete_in(T *elements, int n_elements);
+  void shuffle() {}
+  int to_flat_array(T *elements, int max) const;
+  void insert(T element) { elems.push_back(element); }
+  template <class Iter>
+  void insert(Iter first, Iter last) { elems.insert(elems.end(), first, last); }
+  void remove(T element);
+  void remove_all(const vector<T> &elements);
+
+  /* Traversal */
+  void preorder(void (*f)(const T &)) const { preorder(f, 1); }
+  void inorder(void (*f)(const T &)) const { inorder(f, 1); }
+  void postorder(void (*f)(const T &)) const { postorder(f, 1); }
+  template <class F>
+  bool for_each_preorder(F &&f) const;
+  template <class F>
+  bool for_each_inorder(F &&f) const;
+  template <class F>
+  bool for_each_postorder(F &&f) const;
+
+  /* Input/Output */
+  template <class S>
+  friend ostream &operator<<(ostream &out, const BinaryTree<S, FlatStorage> &src);
+
+  /* Display */
+  void display(PDF *pdf, const string &annotation = "") const;
+
+protected:
+  vector<T> elems; // Elements in complete-tree order, from index 1
+
+  /* "Helper" functions */
+  int size() const { return (int)elems.size() - 1; }
+
+  template <class Match>
+  void remove_matching(Match match);
+
+  void fill_pre(T *elements, int &index, int i);
+  void fill_post(T *elements, int &index, int i);
+  void fill_in(T *elements, int &index, int i);
+
+  void preorder(void (*f)(const T &), int i) const;
+  void inorder(void (*f)(const T &), int i) const;
+  void postorder(void (*f)(const T &), int i) const;
+
+  void write(ostream &out, int i) const;
+  void display(PDF *pdf, int i, int leaf_dist,
+               double x, double y, double scale) const;
+};
+
+#include "BinaryTreeFlat.cpp"
+
+#endif
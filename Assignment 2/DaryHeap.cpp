@@ -0,0 +1,182 @@
+#include "DaryHeap.h"
+#include <utility>
+#include <cassert>
+
+using namespace std;
+
+/*
+ * Layout
+ * ------
+ *
+ * As in 'BinaryTree.cpp', the root is stored at index 1 and cell 0 is
+ * unused.  In a D-ary tree the formulas become
+ *
+ *   parent of node i:           (i - 2)/D + 1
+ *   children of node i:         D*(i - 1) + 2  ...  D*i + 1
+ *
+ * which for D = 2 are the familiar i/2, 2*i and 2*i + 1.
+ *
+ * Every element is stored together with its handle, and for every handle
+ * the heap keeps the index of its element ('pos'), so an element can be
+ * found again after it has moved.
+ */
+
+/****************************************************************************/
+/***                    Implementation of DaryHeap			  ***/
+/****************************************************************************/
+
+/********************/
+/* Access and Tests */
+/********************/
+
+template <class T, int D, class Compare>
+bool DaryHeap<T, D, Compare>::contains(int handle) const
+// Check if the element with 'handle' is still in the heap
+{
+  return handle >= 0 && handle < (int)pos.size() && pos[handle] != 0;
+}
+
+template <class T, int D, class Compare>
+const T &DaryHeap<T, D, Compare>::key(int handle) const
+// PRE: contains(handle)
+// The current key of the element with 'handle'
+{
+  assert(contains(handle));
+  return elems[pos[handle]].elem;
+}
+
+/************/
+/* Mutators */
+/************/
+
+template <class T, int D, class Compare>
+int DaryHeap<T, D, Compare>::push(const T &element)
+// Insert an element and return its handle
+{
+  int handle = new_handle();
+  elems.push_back(Entry{element, handle});
+  pos[handle] = size();
+  sift_up(size());
+  return handle;
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::pop()
+// Remove the top element; its handle may be reused afterwards
+{
+  if (is_empty())
+    return;
+  int n = size();
+  pos[elems[1].handle] = 0;
+  free_handles.push_back(elems[1].handle);
+  if (n > 1)
+    place(1, elems[n]);
+  elems.pop_back();
+  if (n > 2)
+    sift_down(1);
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::decrease_key(int handle, const T &element)
+// PRE: contains(handle), and 'element' is not greater than its current key
+// Replace the key of 'handle' and move it up to its new place
+{
+  assert(contains(handle));
+  int i = pos[handle];
+  elems[i].elem = element;
+  sift_up(i);
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::heapify(const T *elements, int n_elements)
+// Replace the contents by 'elements[0]' ... 'elements[n_elements - 1]',
+// whose handles are 0 ... n_elements - 1.  Sifting down every internal
+// node from the last one up takes O(n) time in total.
+{
+  empty_this();
+  elems.reserve(n_elements + 1);
+  pos.resize(n_elements);
+  for (int i = 0; i < n_elements; ++i)
+  {
+    elems.push_back(Entry{elements[i], i});
+    pos[i] = i + 1;
+  }
+  if (n_elements < 2)
+    return; // parent() of a root-only or empty heap is not a node
+  for (int i = parent(n_elements); i >= 1; --i)
+    sift_down(i);
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::empty_this()
+// Remove every element and forget every handle
+{
+  elems.resize(1);
+  pos.clear();
+  free_handles.clear();
+}
+
+/***********/
+/* Helpers */
+/***********/
+
+template <class T, int D, class Compare>
+int DaryHeap<T, D, Compare>::new_handle()
+// Reuse the handle of a popped element if there is one
+{
+  if (!free_handles.empty())
+  {
+    int handle = free_handles.back();
+    free_handles.pop_back();
+    return handle;
+  }
+  pos.push_back(0);
+  return (int)pos.size() - 1;
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::place(int i, const Entry &entry)
+// Store 'entry' at index 'i'
+{
+  elems[i] = entry;
+  pos[entry.handle] = i;
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::sift_up(int i)
+// Move the element at 'i' up while it is smaller than its parent
+{
+  Entry entry = std::move(elems[i]);
+  while (i > 1 && less_than(entry.elem, elems[parent(i)].elem))
+  {
+    int p = parent(i);
+    place(i, elems[p]);
+    i = p;
+  }
+  place(i, entry);
+}
+
+template <class T, int D, class Compare>
+void DaryHeap<T, D, Compare>::sift_down(int i)
+// Move the element at 'i' down while one of its children is smaller
+{
+  int n = size();
+  Entry entry = std::move(elems[i]);
+  while (true)
+  {
+    int c = first_child(i);
+    if (c > n)
+      break;
+    // find the smallest of the (up to D) children
+    int last = c + D - 1 < n ? c + D - 1 : n;
+    int best = c;
+    for (int j = c + 1; j <= last; ++j)
+      if (less_than(elems[j].elem, elems[best].elem))
+        best = j;
+    if (!less_than(elems[best].elem, entry.elem))
+      break;
+    place(i, elems[best]);
+    i = best;
+  }
+  place(i, entry);
+}
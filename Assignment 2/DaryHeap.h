@@ -0,0 +1,73 @@
+#ifndef __DaryHeap_H
+#define __DaryHeap_H
+
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/****************************************************************************
+ *
+ * CLASS:  DaryHeap
+ *
+ ****************************************************************************/
+
+/* A 'DaryHeap' is a priority queue stored as a complete D-ary tree in a
+ * flat array, the way 'BinaryTree.cpp' describes complete binary trees.
+ * With D = 4 a node's children share a cache line and the tree is half as
+ * deep as a binary heap, so pops touch fewer lines.
+ *
+ * The top is the smallest element according to 'Compare'.  Every pushed
+ * element gets a handle, which stays valid until the element is popped and
+ * can be used to decrease its key.  A popped handle may be given to a later
+ * push, so it must not be used after the pop.
+ */
+
+template <class T, int D = 4, class Compare = less<T> >
+class DaryHeap
+{
+public:
+  /* Construction */
+  DaryHeap() : elems(1) {}
+  DaryHeap(const T *elements, int n_elements) : elems(1) { heapify(elements, n_elements); }
+
+  /* Access and Tests */
+  bool is_empty() const { return size() == 0; }
+  int size() const { return (int)elems.size() - 1; }
+  const T &top() const { return elems[1].elem; }
+  int top_handle() const { return elems[1].handle; }
+  bool contains(int handle) const;
+  const T &key(int handle) const;
+
+  /* Mutators */
+  int push(const T &element);
+  void pop();
+  void decrease_key(int handle, const T &element);
+  void heapify(const T *elements, int n_elements);
+  void empty_this();
+
+protected:
+  struct Entry
+  {
+    T elem;
+    int handle;
+  };
+
+  vector<Entry> elems; // Elements in heap order, from index 1 (index 0 is unused)
+  vector<int> pos;     // Index of the element with each handle (0 if popped)
+  vector<int> free_handles;
+  Compare less_than;
+
+  /* "Helper" functions */
+  static int parent(int i) { return (i - 2) / D + 1; }
+  static int first_child(int i) { return D * (i - 1) + 2; }
+
+  int new_handle();
+  void place(int i, const Entry &entry);
+  void sift_up(int i);
+  void sift_down(int i);
+};
+
+#include "DaryHeap.cpp"
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef __NodeArena_H
+#define __NodeArena_H
+
+#include <vector>
+#include <new>
+#include <utility>
+
+using namespace std;
+
+/****************************************************************************
+ *
+ * CLASSES:  NodeArena, NewDeleteNodes
+ *
+ ****************************************************************************/
+
+/* Node allocation policies for the linked 'BinaryTree' (see
+ * 'LinkedStorage' in 'BinaryTree.h').  Both make and destroy nodes of
+ * type 'Node' and count what they do:
+ *
+ *   make(args...)   construct a node from 'args'
+ *   destroy(node)   destroy a node made by 'make'
+ *   reset()         forget every node at once, without destroying them
+ *                   (only when 'can_reset' is true)
+ */
+
+/* A 'NodeArena' carves nodes out of slabs of 'slab_nodes' nodes, so the
+ * nodes of a tree sit next to each other in the order they were made,
+ * and a tree of n nodes costs n / slab_nodes heap allocations.  Destroyed
+ * nodes go on a free list, linked through their own storage, and are
+ * handed out again before any new slot, so rebuilding a tree reuses the
+ * slots of the old one.  'reset' makes every slot free at once and keeps
+ * the slabs; they are only returned to the heap by the destructor.
+ */
+
+template <class Node>
+class NodeArena
+{
+public:
+  static const bool can_reset = true;
+  static const int slab_nodes = 1024;
+
+  /* Construction */
+  NodeArena() : cur(0), used(0), free_list(NULL), slab_allocs(0), node_allocs(0), node_frees(0) {}
+  ~NodeArena()
+  {
+    for (Node *slab : slabs)
+      ::operator delete(slab);
+  }
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+
+  /* Allocation */
+  template <class... Args>
+  Node *make(Args &&...args);
+  void destroy(Node *node);
+  void reset();
+
+  /* Counters */
+  long heap_allocs() const { return slab_allocs; }
+  long nodes_made() const { return node_allocs; }
+  long nodes_destroyed() const { return node_frees; }
+
+protected:
+  struct FreeSlot
+  {
+    FreeSlot *next;
+  };
+  static_assert(sizeof(Node) >= sizeof(FreeSlot), "a node must be able to hold a free-list link");
+
+  vector<Node *> slabs;
+  size_t cur;          // index of the slab being carved
+  int used;            // number of slots carved from 'slabs[cur]'
+  FreeSlot *free_list; // destroyed nodes
+
+  long slab_allocs, node_allocs, node_frees;
+};
+
+/* 'NewDeleteNodes' makes every node with its own 'new', as the tree used
+ * to; it is kept for comparison */
+
+template <class Node>
+class NewDeleteNodes
+{
+public:
+  static const bool can_reset = false;
+
+  NewDeleteNodes() : node_allocs(0), node_frees(0) {}
+
+  template <class... Args>
+  Node *make(Args &&...args)
+  {
+    ++node_allocs;
+    return new Node(std::forward<Args>(args)...);
+  }
+  void destroy(Node *node)
+  {
+    ++node_frees;
+    delete node;
+  }
+  void reset() {}
+
+  long heap_allocs() const { return node_allocs; }
+  long nodes_made() const { return node_allocs; }
+  long nodes_destroyed() const { return node_frees; }
+
+protected:
+  long node_allocs, node_frees;
+};
+
+/****************************************************************************/
+/***                    Implementation of NodeArena			  ***/
+/****************************************************************************/
+
+template <class Node>
+template <class... Args>
+Node *NodeArena<Node>::make(Args &&...args)
+// Construct a node in a free slot, reusing destroyed nodes first
+{
+  void *slot;
+  if (free_list)
+  {
+    slot = free_list;
+    free_list = free_list->next;
+  }
+  else
+  {
+    if (cur < slabs.size() && used == slab_nodes)
+    {
+      ++cur;
+      used = 0;
+    }
+    if (cur == slabs.size())
+    {
+      slabs.push_back((Node *)::operator new(slab_nodes * sizeof(Node)));
+      ++slab_allocs;
+    }
+    slot = slabs[cur] + used++;
+  }
+  ++node_allocs;
+  return new (slot) Node(std::forward<Args>(args)...);
+}
+
+template <class Node>
+void NodeArena<Node>::destroy(Node *node)
+// Destroy 'node' and put its slot on the free list
+{
+  node->~Node();
+  FreeSlot *slot = (FreeSlot *)(void *)node;
+  slot->next = free_list;
+  free_list = slot;
+  ++node_frees;
+}
+
+template <class Node>
+void NodeArena<Node>::reset()
+// PRE: the nodes need no destructor, or have been destroyed
+// Make every slot free again, in O(1); the slabs are kept for reuse
+{
+  cur = 0;
+  used = 0;
+  free_list = NULL;
+}
+
+#endif
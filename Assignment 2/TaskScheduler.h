@@ -0,0 +1,243 @@
+#ifndef __TaskScheduler_H
+#define __TaskScheduler_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <exception>
+
+#include "WorkStealingDeque.h"
+
+using namespace std;
+
+/****************************************************************************
+ *
+ * CLASS:  TaskScheduler
+ *
+ ****************************************************************************/
+
+/* A 'TaskScheduler' runs fork-join work on a fixed set of threads, each
+ * with its own 'WorkStealingDeque' of tasks:
+ *
+ *   TaskGroup g;
+ *   sched.spawn(g, [&] { left = work(a); });   // may run on another thread
+ *   right = work(b);                           // meanwhile, on this one
+ *   sched.sync(g);                             // wait for 'left'
+ *
+ * A thread pushes the tasks it spawns on its own deque and pops them back
+ * in LIFO order; an idle thread steals the oldest task of a random other
+ * thread.  A thread waiting in 'sync' does not block: it keeps running
+ * tasks (its own first, then stolen ones) until its group is done, so
+ * tasks may spawn and sync recursively.
+ *
+ * A task may throw:  the first exception thrown by a task of a group is
+ * kept, the other tasks of the group still run, and 'sync' rethrows it
+ * once they are all done.
+ *
+ * The thread that creates the scheduler works as thread 0, and it is the
+ * only thread outside the scheduler that may call 'spawn' and 'sync'.  The
+ * other threads spin for a while when they run out of work, then sleep
+ * until a task is spawned (or for at most a millisecond).
+ */
+
+/* A set of spawned tasks that can be waited for together */
+struct TaskGroup
+{
+  atomic<int> pending;
+  atomic<bool> failed; // set by the first task that throws
+  exception_ptr error; // what it threw
+
+  TaskGroup() : pending(0), failed(false) {}
+};
+
+class TaskScheduler
+{
+public:
+  /* Construction */
+  TaskScheduler(int n_threads = 0);
+  ~TaskScheduler();
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /* Access and Tests */
+  int thread_count() const { return (int)deques.size(); }
+
+  /* Fork-join */
+  template <class F>
+  void spawn(TaskGroup &group, F f);
+  void sync(TaskGroup &group);
+
+protected:
+  struct Task
+  {
+    function<void()> f;
+    TaskGroup *group;
+  };
+
+  vector<WorkStealingDeque<Task *> *> deques; // one per thread, [0] for the creator
+  vector<thread> workers;                     // threads 1 ... n - 1
+  atomic<bool> stopping;
+  atomic<int> sleeping; // workers waiting on 'wake'
+  mutex m;
+  condition_variable wake;
+
+  /* "Helper" functions */
+  int self() const;
+  bool run_one(int i, unsigned &seed);
+  void worker(int i);
+};
+
+/****************************************************************************/
+/***                   Implementation of TaskScheduler			  ***/
+/****************************************************************************/
+
+/* The scheduler and index of the calling thread; threads outside any
+ * scheduler count as thread 0 */
+struct TaskSchedulerThread
+{
+  const TaskScheduler *sched;
+  int index;
+};
+
+inline TaskSchedulerThread &current_task_thread()
+{
+  static thread_local TaskSchedulerThread t = {NULL, 0};
+  return t;
+}
+
+inline TaskScheduler::TaskScheduler(int n_threads)
+    : stopping(false), sleeping(0)
+{
+  if (n_threads <= 0)
+    n_threads = max(1, (int)thread::hardware_concurrency());
+  for (int i = 0; i < n_threads; ++i)
+    deques.push_back(new WorkStealingDeque<Task *>());
+  for (int i = 1; i < n_threads; ++i)
+    workers.emplace_back(&TaskScheduler::worker, this, i);
+}
+
+inline TaskScheduler::~TaskScheduler()
+{
+  {
+    lock_guard<mutex> lock(m);
+    stopping.store(true);
+  }
+  wake.notify_all();
+  for (thread &t : workers)
+    t.join();
+  for (WorkStealingDeque<Task *> *d : deques)
+  {
+    Task *task;
+    while (d->pop(task))
+      delete task;
+    delete d;
+  }
+}
+
+template <class F>
+void TaskScheduler::spawn(TaskGroup &group, F f)
+// Queue 'f' to run on any thread, as part of 'group'
+{
+  group.pending.fetch_add(1, memory_order_relaxed);
+  deques[self()]->push(new Task{function<void()>(std::move(f)), &group});
+  if (sleeping.load(memory_order_relaxed) > 0)
+    wake.notify_one();
+}
+
+inline void TaskScheduler::sync(TaskGroup &group)
+// Run tasks until every task of 'group' has finished, then rethrow the
+// first exception one of them threw, if any
+{
+  int i = self();
+  unsigned seed = i + 1;
+  while (group.pending.load(memory_order_acquire) > 0)
+    if (!run_one(i, seed))
+      this_thread::yield();
+  if (group.failed.load(memory_order_relaxed))
+  {
+    exception_ptr error = group.error;
+    group.error = nullptr;
+    group.failed.store(false, memory_order_relaxed);
+    rethrow_exception(error);
+  }
+}
+
+/***********/
+/* Helpers */
+/***********/
+
+inline int TaskScheduler::self() const
+// Index of the calling thread in this scheduler
+{
+  const TaskSchedulerThread &t = current_task_thread();
+  return t.sched == this ? t.index : 0;
+}
+
+inline bool TaskScheduler::run_one(int i, unsigned &seed)
+// Run one task of thread 'i', or else one stolen from a random thread;
+// false if there was none
+{
+  Task *task = NULL;
+  if (!deques[i]->pop(task))
+  {
+    int n = thread_count();
+    seed = seed * 1103515245 + 12345;
+    int start = (seed >> 16) % n;
+    for (int k = 0; k < n && !task; ++k)
+    {
+      int victim = (start + k) % n;
+      if (victim == i || !deques[victim]->steal(task))
+        task = NULL;
+    }
+    if (!task)
+      return false;
+  }
+  TaskGroup *group = task->group;
+  try
+  {
+    task->f();
+  }
+  catch (...)
+  {
+    // kept for 'sync'; the release below publishes it
+    if (!group->failed.exchange(true, memory_order_relaxed))
+      group->error = current_exception();
+  }
+  delete task;
+  group->pending.fetch_sub(1, memory_order_release);
+  return true;
+}
+
+inline void TaskScheduler::worker(int i)
+// Main loop of thread 'i'
+{
+  current_task_thread() = TaskSchedulerThread{this, i};
+  unsigned seed = i + 1;
+  int idle = 0;
+  while (!stopping.load(memory_order_relaxed))
+  {
+    if (run_one(i, seed))
+    {
+      idle = 0;
+      continue;
+    }
+    if (++idle < 256)
+    {
+      this_thread::yield();
+      continue;
+    }
+    // nothing to do for a while: sleep until 'spawn' wakes us up
+    unique_lock<mutex> lock(m);
+    sleeping.fetch_add(1);
+    if (!stopping.load())
+      wake.wait_for(lock, chrono::milliseconds(1));
+    sleeping.fetch_sub(1);
+    idle = 0;
+  }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include "WorkStealingDeque.h"
+
+using namespace std;
+
+/****************************************************************************/
+/***                 Implementation of WorkStealingDeque		  ***/
+/****************************************************************************/
+
+template <class T>
+WorkStealingDeque<T>::WorkStealingDeque(long capacity)
+    : top(0), bottom(0)
+{
+  long cap = 2;
+  while (cap < capacity)
+    cap *= 2;
+  ring.store(new Ring(cap), memory_order_relaxed);
+}
+
+template <class T>
+WorkStealingDeque<T>::~WorkStealingDeque()
+{
+  delete ring.load(memory_order_relaxed);
+  for (Ring *r : retired)
+    delete r;
+}
+
+template <class T>
+long WorkStealingDeque<T>::size() const
+// Number of elements; only exact while no other thread is running
+{
+  return bottom.load(memory_order_relaxed) - top.load(memory_order_relaxed);
+}
+
+template <class T>
+void WorkStealingDeque<T>::push(T element)
+// Owner: insert 'element' at the bottom, growing the ring if it is full
+{
+  long b = bottom.load(memory_order_relaxed);
+  long t = top.load(memory_order_acquire);
+  Ring *r = ring.load(memory_order_relaxed);
+  if (b - t > r->cap - 1)
+    r = grow(r, t, b);
+  r->put(b, element);
+  atomic_thread_fence(memory_order_release);
+  bottom.store(b + 1, memory_order_relaxed);
+}
+
+template <class T>
+bool WorkStealingDeque<T>::pop(T &element)
+// Owner: take the most recently pushed element, unless the deque is empty
+{
+  long b = bottom.load(memory_order_relaxed) - 1;
+  Ring *r = ring.load(memory_order_relaxed);
+  bottom.store(b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  long t = top.load(memory_order_relaxed);
+  if (t > b)
+  {
+    // empty
+    bottom.store(b + 1, memory_order_relaxed);
+    return false;
+  }
+  element = r->get(b);
+  if (t == b)
+  {
+    // last element: race the thieves for it
+    bool won = top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    bottom.store(b + 1, memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+template <class T>
+bool WorkStealingDeque<T>::steal(T &element)
+// Any thread: take the oldest element, unless the deque is empty or
+// another thread got it first
+{
+  long t = top.load(memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  long b = bottom.load(memory_order_acquire);
+  if (t >= b)
+    return false;
+  Ring *r = ring.load(memory_order_acquire);
+  element = r->get(t);
+  return top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+template <class T>
+typename WorkStealingDeque<T>::Ring *WorkStealingDeque<T>::grow(Ring *r, long t, long b)
+// Owner: copy the elements 't' ... 'b - 1' to a ring twice as large
+{
+  Ring *bigger = new Ring(2 * r->cap);
+  for (long i = t; i < b; ++i)
+    bigger->put(i, r->get(i));
+  retired.push_back(r);
+  ring.store(bigger, memory_order_release);
+  return bigger;
+}
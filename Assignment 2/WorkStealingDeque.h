@@ -0,0 +1,79 @@
+#ifndef __WorkStealingDeque_H
+#define __WorkStealingDeque_H
+
+#include <atomic>
+#include <vector>
+#include <type_traits>
+
+using namespace std;
+
+/****************************************************************************
+ *
+ * CLASS:  WorkStealingDeque
+ *
+ ****************************************************************************/
+
+/* A 'WorkStealingDeque' is the Chase-Lev deque: one thread, the owner,
+ * pushes and pops at the bottom end, and any other thread may steal from
+ * the top end.  The owner works LIFO on its most recent (and cache-hot)
+ * tasks while thieves take the oldest ones, which in a fork-join program
+ * are the biggest.
+ *
+ * The elements live in a ring indexed like 'Queue' in Assignment 1: the
+ * capacity is a power of two, 'top' and 'bottom' keep counting up, and a
+ * cell is found by masking the index with capacity - 1.  A full ring is
+ * replaced by one twice as large; the old ring is kept until the deque is
+ * destroyed, since a thief may still be reading from it.
+ *
+ * The memory orderings follow Le, Pop, Cohen and Zappa Nardelli, "Correct
+ * and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ *
+ * T must be trivially copyable (typically a pointer to a task).
+ */
+
+template <class T>
+class WorkStealingDeque
+{
+  static_assert(is_trivially_copyable<T>::value, "WorkStealingDeque holds plain values such as pointers");
+
+public:
+  /* Construction */
+  WorkStealingDeque(long capacity = 1024);
+  ~WorkStealingDeque();
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  /* Access and Tests */
+  long size() const;
+  bool is_empty() const { return size() <= 0; }
+
+  /* Owner */
+  void push(T element);
+  bool pop(T &element);
+
+  /* Any thread */
+  bool steal(T &element);
+
+protected:
+  struct Ring
+  {
+    long cap; // a power of two
+    atomic<T> *cells;
+
+    Ring(long capacity) : cap(capacity), cells(new atomic<T>[capacity]) {}
+    ~Ring() { delete[] cells; }
+    T get(long i) const { return cells[i & (cap - 1)].load(memory_order_relaxed); }
+    void put(long i, T x) { cells[i & (cap - 1)].store(x, memory_order_relaxed); }
+  };
+
+  alignas(64) atomic<long> top;    // next element to steal
+  alignas(64) atomic<long> bottom; // next free cell at the owner's end
+  atomic<Ring *> ring;
+  vector<Ring *> retired; // outgrown rings (touched by the owner only)
+
+  Ring *grow(Ring *r, long t, long b);
+};
+
+#include "WorkStealingDeque.cpp"
+
+#endif
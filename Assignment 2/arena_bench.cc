@@ -0,0 +1,143 @@
+#include "BinaryTree.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+using namespace std;
+
+/* Hardware cache-miss counter of this thread, if the kernel lets us
+ * open one (it often does not in containers and VMs) */
+struct CacheMisses
+{
+  int fd;
+
+  CacheMisses()
+  {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+  ~CacheMisses()
+  {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  bool available() const { return fd >= 0; }
+  void start()
+  {
+    if (fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+  long stop()
+  {
+    long long count = -1;
+    if (fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &count, sizeof(count)) != sizeof(count))
+        count = -1;
+    }
+    return count;
+  }
+};
+
+CacheMisses misses;
+long sum;
+void add(const int &x) { sum += x; }
+
+/* Time of 'f' in milliseconds; 'miss_count' gets its cache misses, or -1 */
+template <class F>
+double ms(F f, long &miss_count)
+{
+  misses.start();
+  auto start = chrono::steady_clock::now();
+  f();
+  auto stop = chrono::steady_clock::now();
+  miss_count = misses.stop();
+  return chrono::duration_cast<chrono::duration<double, milli> >(stop - start).count();
+}
+
+/* Exposes the allocator of a tree */
+template <template <class> class Alloc>
+struct Tree : public BinaryTree<int, LinkedStorage<Alloc> >
+{
+  const Alloc<BTNode<int> > &allocator() const { return this->nodes; }
+};
+
+/* One line of results: time, heap allocations made and cache misses */
+void print(const char *step, double ms, long allocs, long miss_count)
+{
+  cout << "  " << step << "\t" << ms << " ms\t" << allocs << " node heap allocations";
+  if (miss_count >= 0)
+    cout << "\t" << miss_count << " cache misses";
+  cout << "\n";
+}
+
+/* Build, traverse, rebuild (shuffle) and empty a tree of 'n' nodes */
+template <template <class> class Alloc>
+void run(const char *name, const vector<int> &elements)
+{
+  cout << name << "\n";
+  Tree<Alloc> *tree = new Tree<Alloc>;
+  long miss_count, allocs = 0;
+  double t;
+
+  t = ms([&]
+         { tree->insert(elements.begin(), elements.end()); }, miss_count);
+  print("build", t, tree->allocator().heap_allocs() - allocs, miss_count);
+
+  allocs = tree->allocator().heap_allocs();
+  t = ms([&]
+         { sum = 0; tree->preorder(add); }, miss_count);
+  print("preorder", t, tree->allocator().heap_allocs() - allocs, miss_count);
+
+  allocs = tree->allocator().heap_allocs();
+  t = ms([&]
+         { tree->shuffle(); }, miss_count);
+  print("shuffle", t, tree->allocator().heap_allocs() - allocs, miss_count);
+
+  allocs = tree->allocator().heap_allocs();
+  t = ms([&]
+         { sum = 0; tree->preorder(add); }, miss_count);
+  print("preorder", t, tree->allocator().heap_allocs() - allocs, miss_count);
+
+  allocs = tree->allocator().heap_allocs();
+  t = ms([&]
+         { tree->empty_this(); }, miss_count);
+  print("empty_this", t, tree->allocator().heap_allocs() - allocs, miss_count);
+
+  delete tree;
+}
+
+/* Usage: arena_bench [nodes] */
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+  vector<int> elements(n);
+  for (int i = 0; i < n; ++i)
+    elements[i] = i;
+
+  cout << "Tree of " << n << " ints";
+  if (!misses.available())
+    cout << " (no hardware cache-miss counter here)";
+  cout << "\n";
+  run<NewDeleteNodes>("new/delete per node", elements);
+  run<NodeArena>("NodeArena", elements);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include "DaryHeap.h"
+#include <iostream>
+#include <queue>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+/* Check push, pop, decrease_key and heapify against a plain array */
+bool check_heap()
+{
+  mt19937 rng(1);
+  DaryHeap<int, 4> heap;
+  vector<int> keys; // keys[handle], or -1 if popped
+  for (int step = 0; step < 100000; ++step)
+  {
+    int op = rng() % 10;
+    if (op < 5)
+    {
+      int h = heap.push(rng() % 1000000);
+      if (h >= (int)keys.size())
+        keys.resize(h + 1, -1);
+      keys[h] = heap.key(h);
+    }
+    else if (op < 8 && !heap.is_empty())
+    {
+      int best = -1;
+      for (int k : keys)
+        if (k >= 0 && (best < 0 || k < best))
+          best = k;
+      if (heap.top() != best)
+        return false;
+      keys[heap.top_handle()] = -1;
+      heap.pop();
+    }
+    else if (!heap.is_empty())
+    {
+      int h = rng() % keys.size();
+      if (keys[h] >= 0 && heap.contains(h))
+      {
+        keys[h] /= 2;
+        heap.decrease_key(h, keys[h]);
+      }
+    }
+  }
+
+  vector<int> elements(10000);
+  for (int &x : elements)
+    x = rng() % 1000;
+  DaryHeap<int, 3> built(&elements[0], elements.size());
+  sort(elements.begin(), elements.end());
+  for (int x : elements)
+  {
+    if (built.top() != x)
+      return false;
+    built.pop();
+  }
+  if (!built.is_empty())
+    return false;
+
+  DaryHeap<int, 4> none(elements.data(), 0);
+  if (!none.is_empty())
+    return false;
+  DaryHeap<int, 4> one(elements.data(), 1);
+  if (one.top() != elements[0])
+    return false;
+  one.pop();
+  return one.is_empty();
+}
+
+volatile long sink;
+
+/* Run 'n_ops' mixed operations (60% push, 40% pop) on a heap-like type;
+ * returns the time in seconds */
+template <class H>
+double mixed(int n_ops, H &heap)
+{
+  mt19937 rng(2);
+  long sum = 0;
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < n_ops; ++i)
+  {
+    if (rng() % 10 < 6 || heap.empty())
+      heap.push(rng());
+    else
+    {
+      sum += heap.top();
+      heap.pop();
+    }
+  }
+  auto stop = chrono::steady_clock::now();
+  sink = sum; // keep the pops from being optimized away
+  return chrono::duration_cast<chrono::duration<double> >(stop - start).count();
+}
+
+/* Adapter giving DaryHeap the std::priority_queue interface */
+template <int D>
+struct Dary
+{
+  DaryHeap<unsigned, D> h;
+  bool empty() const { return h.is_empty(); }
+  void push(unsigned x) { h.push(x); }
+  unsigned top() const { return h.top(); }
+  void pop() { h.pop(); }
+};
+
+int main(int argc, char *argv[])
+{
+  if (!check_heap())
+  {
+    cerr << "DaryHeap check failed\n";
+    return 1;
+  }
+
+  int n_ops = argc > 1 ? atoi(argv[1]) : 10000000;
+  priority_queue<unsigned, vector<unsigned>, greater<unsigned> > stl;
+  Dary<2> binary;
+  Dary<4> quad;
+  Dary<8> oct;
+  cout << n_ops << " mixed operations (ns/op)\n";
+  cout << "std::priority_queue\t" << mixed(n_ops, stl) / n_ops * 1e9 << "\n";
+  cout << "DaryHeap<2>\t\t" << mixed(n_ops, binary) / n_ops * 1e9 << "\n";
+  cout << "DaryHeap<4>\t\t" << mixed(n_ops, quad) / n_ops * 1e9 << "\n";
+  cout << "DaryHeap<8>\t\t" << mixed(n_ops, oct) / n_ops * 1e9 << "\n";
+
+  return 0;
+}
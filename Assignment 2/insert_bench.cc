@@ -0,0 +1,99 @@
+#include "BinaryTree.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+/* The tree with the previous insert, which searched breadth first for
+ * the first open position */
+struct BfsTree : public BinaryTree<int>
+{
+  void bfs_insert(int element)
+  {
+    ++n_nodes;
+    if (!root)
+    {
+      root = nodes.make(element);
+      return;
+    }
+    queue<BTNode<int> *> q;
+    q.push(root);
+    while (true)
+    {
+      BTNode<int> *curr = q.front();
+      q.pop();
+      if (!curr->left)
+      {
+        curr->left = nodes.make(element);
+        return;
+      }
+      if (!curr->right)
+      {
+        curr->right = nodes.make(element);
+        return;
+      }
+      q.push(curr->left);
+      q.push(curr->right);
+    }
+  }
+};
+
+/* Time of 'f' in seconds */
+template <class F>
+double seconds(F f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  auto stop = chrono::steady_clock::now();
+  return chrono::duration_cast<chrono::duration<double> >(stop - start).count();
+}
+
+/* Build trees of 'n' elements one at a time and in bulk; prints ns per
+ * element */
+void run(int n)
+{
+  vector<int> elements(n);
+  for (int i = 0; i < n; ++i)
+    elements[i] = i;
+
+  BinaryTree<int> *one = new BinaryTree<int>;
+  double t_one = seconds([&]
+                         { for (int x : elements) one->insert(x); });
+  delete one;
+
+  BinaryTree<int> *bulk = new BinaryTree<int>;
+  double t_bulk = seconds([&]
+                          { bulk->insert(elements.begin(), elements.end()); });
+  if (bulk->node_count() != n)
+    cerr << "Wrong node count!\n";
+  delete bulk;
+
+  BinaryTree<int, FlatStorage> *flat = new BinaryTree<int, FlatStorage>;
+  double t_flat = seconds([&]
+                          { for (int x : elements) flat->insert(x); });
+  delete flat;
+
+  cout << n << "\t" << t_one / n * 1e9 << "\t\t" << t_bulk / n * 1e9 << "\t\t" << t_flat / n * 1e9 << "\n";
+}
+
+/* Usage: insert_bench [largest size]
+ * Builds trees of 1e6 elements, then 10 times more, up to the largest
+ * size (1e7 by default; 1e8 linked nodes need about 3.2 GB) */
+int main(int argc, char *argv[])
+{
+  int largest = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  int small = 20000;
+  BfsTree bfs;
+  double t_bfs = seconds([&]
+                         { for (int i = 0; i < small; ++i) bfs.bfs_insert(i); });
+  cout << "Previous breadth-first insert, " << small << " elements: " << t_bfs / small * 1e9 << " ns/element\n";
+
+  cout << "elements\tinsert (ns)\tinsert(range) (ns)\tflat insert (ns)\n";
+  for (long n = 1000000; n <= largest; n *= 10)
+    run(n);
+
+  return 0;
+}
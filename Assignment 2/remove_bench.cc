@@ -0,0 +1,134 @@
+#include "BinaryTree.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+/* Count every allocation and deallocation of the program */
+long n_allocs = 0, n_frees = 0;
+
+void *operator new(size_t size)
+{
+  ++n_allocs;
+  if (void *p = malloc(size))
+    return p;
+  throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  if (p)
+    ++n_frees;
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  operator delete(p);
+}
+
+/* The tree with the previous remove, which unlinked the matching nodes
+ * and then rebuilt the whole tree with 'shuffle' to make it complete */
+struct ShuffleTree : public BinaryTree<int>
+{
+  void shuffle_remove(int element)
+  {
+    root = remove(element, root);
+    shuffle();
+    n_nodes = node_count(root);
+  }
+
+  BTNode<int> *remove(int element, BTNode<int> *node)
+  {
+    if (!node)
+      return NULL;
+    if (node->elem == element)
+    {
+      if (!node->left || !node->right)
+      {
+        BTNode<int> *tmp = node->left ? node->left : node->right;
+        nodes.destroy(node);
+        return remove(element, tmp);
+      }
+      node->left = remove(element, node->left);
+      BTNode<int> *tmp = node->right, *prev = NULL;
+      for (; tmp->left; prev = tmp, tmp = tmp->left)
+        ;
+      node->elem = tmp->elem;
+      if (prev == NULL)
+        node->right = tmp->right;
+      else
+        prev->left = tmp->right;
+      nodes.destroy(tmp);
+      node->right = remove(element, node->right);
+      return node;
+    }
+    node->left = remove(element, node->left);
+    node->right = remove(element, node->right);
+    return node;
+  }
+};
+
+/* Time of 'f' in microseconds */
+template <class F>
+double micros(F f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  auto stop = chrono::steady_clock::now();
+  return chrono::duration_cast<chrono::duration<double, micro> >(stop - start).count();
+}
+
+/* Print the mean latency and allocations per removed element of 'f',
+ * which removes 'k' elements */
+template <class F>
+void report(const char *name, int k, F f)
+{
+  long allocs = n_allocs, frees = n_frees;
+  double us = micros(f);
+  cout << name << "\t" << us / k << " us\t" << double(n_allocs - allocs) / k << "\t"
+       << double(n_frees - frees) / k << "\n";
+}
+
+/* Usage: remove_bench [nodes] [removals]
+ * Removes random elements from a complete tree of distinct elements */
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 100000;
+  int k = argc > 2 ? atoi(argv[2]) : 200;
+
+  vector<int> elements(n);
+  for (int i = 0; i < n; ++i)
+    elements[i] = i;
+  vector<int> victims;
+  mt19937 rng(4);
+  for (int i = 0; i < k; ++i)
+    victims.push_back(rng() % n);
+
+  cout << "Removing " << k << " of " << n << " elements\n";
+  cout << "method\t\tlatency\tallocs\tfrees (per removal)\n";
+
+  ShuffleTree old_tree;
+  old_tree.insert(elements.begin(), elements.end());
+  report("remove + shuffle", k, [&]
+         { for (int x : victims) old_tree.shuffle_remove(x); });
+
+  BinaryTree<int> tree;
+  tree.insert(elements.begin(), elements.end());
+  report("remove\t", k, [&]
+         { for (int x : victims) tree.remove(x); });
+
+  BinaryTree<int> batch;
+  batch.insert(elements.begin(), elements.end());
+  report("remove_all", k, [&]
+         { batch.remove_all(victims); });
+
+  if (old_tree.node_count() != tree.node_count() || tree.node_count() != batch.node_count())
+    cerr << "The trees disagree!\n";
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+#include "BinaryTree.h"
+#include "TaskScheduler.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+/* Push 'n' values on a deque while its owner pops some and 'n_thieves'
+ * threads steal the rest; every value must be taken exactly once */
+bool check_deque(int n, int n_thieves)
+{
+  WorkStealingDeque<int> deque(4); // small, so that it grows under the thieves
+  vector<atomic<int> > taken(n);
+  atomic<bool> done(false);
+  vector<thread> thieves;
+  for (int t = 0; t < n_thieves; ++t)
+    thieves.emplace_back([&]
+                         {
+      int x;
+      while (!done.load())
+        if (deque.steal(x))
+          taken[x].fetch_add(1); });
+  int x;
+  for (int i = 0; i < n; ++i)
+  {
+    deque.push(i);
+    if (i % 3 == 0 && deque.pop(x))
+      taken[x].fetch_add(1);
+  }
+  while (deque.pop(x))
+    taken[x].fetch_add(1);
+  done.store(true);
+  for (thread &t : thieves)
+    t.join();
+  for (int i = 0; i < n; ++i)
+    if (taken[i].load() != 1)
+      return false;
+  return true;
+}
+
+/* Spawn tasks of which some throw, some of them from a nested group:
+ * 'sync' must rethrow only after every task has run, and the group must
+ * then be usable again */
+bool check_exceptions(int n_threads)
+{
+  TaskScheduler sched(n_threads);
+  atomic<int> ran(0);
+  TaskGroup group;
+  for (int i = 0; i < 100; ++i)
+    sched.spawn(group, [&, i]
+                {
+      if (i % 10 == 3)
+        throw runtime_error("task failed");
+      if (i % 10 == 7)
+      {
+        TaskGroup inner;
+        sched.spawn(inner, []
+                    { throw runtime_error("nested task failed"); });
+        sched.sync(inner);
+      }
+      ran.fetch_add(1); });
+  bool thrown = false;
+  try
+  {
+    sched.sync(group);
+  }
+  catch (const runtime_error &)
+  {
+    thrown = true;
+  }
+  if (!thrown || ran.load() != 80 || group.pending.load() != 0)
+    return false;
+  sched.spawn(group, [&]
+              { ran.fetch_add(1); });
+  sched.sync(group);
+  return ran.load() == 81;
+}
+
+/* Fibonacci, spawning one branch down to 'spawn_depth' levels */
+long fib(TaskScheduler &sched, int n, int spawn_depth)
+{
+  if (n < 2)
+    return n;
+  if (spawn_depth == 0)
+    return fib(sched, n - 1, 0) + fib(sched, n - 2, 0);
+  long a = 0;
+  TaskGroup group;
+  sched.spawn(group, [&]
+              { a = fib(sched, n - 1, spawn_depth - 1); });
+  long b = fib(sched, n - 2, spawn_depth - 1);
+  sched.sync(group);
+  return a + b;
+}
+
+/* Best of 5 runs of 'f', in milliseconds */
+template <class F>
+double best_ms(F f)
+{
+  double best = 0;
+  for (int r = 0; r < 5; ++r)
+  {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto stop = chrono::steady_clock::now();
+    double ms = chrono::duration_cast<chrono::duration<double, milli> >(stop - start).count();
+    if (r == 0 || ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+int main(int argc, char *argv[])
+{
+  if (!check_deque(1000000, 3))
+  {
+    cerr << "WorkStealingDeque check failed\n";
+    return 1;
+  }
+  if (!check_exceptions(1) || !check_exceptions(4))
+  {
+    cerr << "TaskScheduler exception check failed\n";
+    return 1;
+  }
+
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+  int cores = max(1, (int)thread::hardware_concurrency());
+  vector<int> counts = {1, 2, 4};
+  if (cores > 4)
+    counts.push_back(cores);
+  if (cores < 2)
+    cout << "Only one core: the threads share it\n";
+
+  vector<int> elements(n);
+  for (int i = 0; i < n; ++i)
+    elements[i] = i;
+  BinaryTree<int> tree;
+  tree.init_complete(&elements[0], n);
+
+  volatile long sink = 0;
+  cout << "node_count over " << n << " nodes (ms)\n";
+  cout << "serial\t\t" << best_ms([&]
+                                  { sink = tree.node_count(); })
+       << "\n";
+  for (int threads : counts)
+  {
+    TaskScheduler sched(threads);
+    double ms = best_ms([&]
+                        { sink = tree.node_count(sched); });
+    if (tree.node_count(sched) != n)
+      cerr << "Wrong node count!\n";
+    cout << threads << " threads\t" << ms << "\n";
+  }
+
+  cout << "fib(32), spawning down to 12 levels (ms)\n";
+  cout << "serial\t\t" << best_ms([&]
+                                  { TaskScheduler one(1); sink = fib(one, 32, 0); })
+       << "\n";
+  for (int threads : counts)
+  {
+    TaskScheduler sched(threads);
+    cout << threads << " threads\t" << best_ms([&]
+                                                 { sink = fib(sched, 32, 12); })
+         << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include "BinaryTree.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+/* The function-pointer traversals can only add up through a global */
+long sum;
+void add(const int &x) { sum += x; }
+
+/* Best of 3 runs of 'f', in milliseconds */
+template <class F>
+double best_ms(F f)
+{
+  double best = 0;
+  for (int r = 0; r < 3; ++r)
+  {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto stop = chrono::steady_clock::now();
+    double ms = chrono::duration_cast<chrono::duration<double, milli> >(stop - start).count();
+    if (r == 0 || ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+volatile long sink;
+
+/* Compare the three orders both ways on 'tree' */
+template <class Tree>
+void run(const char *name, const Tree &tree, int n)
+{
+  cout << name << "\tfunction pointer (ms)\tfor_each (ms)\n";
+  cout << "preorder\t" << best_ms([&]
+                                  { sum = 0; tree.preorder(add); sink = sum; })
+       << "\t\t" << best_ms([&]
+                            { long s = 0; tree.for_each_preorder([&s](const int &x)
+                                                                 { s += x; }); sink = s; })
+       << "\n";
+  cout << "inorder \t" << best_ms([&]
+                                  { sum = 0; tree.inorder(add); sink = sum; })
+       << "\t\t" << best_ms([&]
+                            { long s = 0; tree.for_each_inorder([&s](const int &x)
+                                                                { s += x; }); sink = s; })
+       << "\n";
+  cout << "postorder\t" << best_ms([&]
+                                   { sum = 0; tree.postorder(add); sink = sum; })
+       << "\t\t" << best_ms([&]
+                            { long s = 0; tree.for_each_postorder([&s](const int &x)
+                                                                  { s += x; }); sink = s; })
+       << "\n";
+
+  // look for one element:  only the visitor can stop when it is found
+  int wanted = n / 2;
+  cout << "find " << wanted << "\t\t\t\t" << best_ms([&]
+                                                    { long found = 0; tree.for_each_preorder([&](const int &x)
+                                                                                            { return x == wanted ? (found = 1, false) : true; }); sink = found; })
+       << "\n";
+}
+
+/* The recursive orders, for checking the visitors */
+vector<int> order;
+void record(const int &x) { order.push_back(x); }
+
+/* A tree that is not complete:  a spine of 'n' nodes going left, each
+ * with a leaf on its right, deep enough to overflow the fixed part of
+ * the traversal stacks */
+class CaterpillarTree : public BinaryTree<int>
+{
+public:
+  CaterpillarTree(int n)
+  {
+    BTNode<int> **link = &root;
+    for (int i = 0; i < n; ++i)
+    {
+      *link = nodes.make(2 * i);
+      (*link)->right = nodes.make(2 * i + 1);
+      link = &(*link)->left;
+    }
+    n_nodes = 2 * n;
+  }
+};
+
+/* Check that the visitors see the same elements, in the same order, as
+ * the recursive traversals, and stop as soon as they return false */
+template <class Tree>
+bool check_orders(const char *name, const Tree &tree, int n)
+{
+  vector<int> seen;
+  auto collect = [&seen](const int &x)
+  { seen.push_back(x); };
+  bool same = true;
+  order.clear(), seen.clear();
+  tree.preorder(record), tree.for_each_preorder(collect);
+  same = same && seen == order;
+  order.clear(), seen.clear();
+  tree.inorder(record), tree.for_each_inorder(collect);
+  same = same && seen == order;
+  order.clear(), seen.clear();
+  tree.postorder(record), tree.for_each_postorder(collect);
+  same = same && seen == order;
+  for (int k = 1; k <= n; k += max(1, n / 3))
+  {
+    int count = 0;
+    auto stop = [&count, k](const int &)
+    { return ++count < k; };
+    same = same && !tree.for_each_preorder(stop) && count == k;
+    count = 0;
+    same = same && !tree.for_each_inorder(stop) && count == k;
+    count = 0;
+    same = same && !tree.for_each_postorder(stop) && count == k;
+  }
+  if (!same)
+    cerr << name << " visitor disagrees with the recursive traversal on " << n << " nodes\n";
+  return same;
+}
+
+bool check_traversals()
+{
+  for (int n = 0; n <= 200; ++n)
+  {
+    vector<int> elements(n);
+    for (int i = 0; i < n; ++i)
+      elements[i] = i;
+    BinaryTree<int> linked;
+    linked.insert(elements.begin(), elements.end());
+    BinaryTree<int, FlatStorage> flat(elements.data(), n);
+    if (!check_orders("linked", linked, n) || !check_orders("flat", flat, n))
+      return false;
+  }
+  CaterpillarTree deep(200);
+  return check_orders("caterpillar", deep, 400);
+}
+
+/* Usage: traversal_bench [nodes] */
+int main(int argc, char *argv[])
+{
+  if (!check_traversals())
+    return 1;
+
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+  vector<int> elements(n);
+  for (int i = 0; i < n; ++i)
+    elements[i] = i;
+
+  cout << "Complete tree of " << n << " ints\n";
+  BinaryTree<int> *linked = new BinaryTree<int>;
+  linked->insert(elements.begin(), elements.end());
+  run("linked", *linked, n);
+  delete linked;
+
+  BinaryTree<int, FlatStorage> flat(&elements[0], n);
+  run("flat  ", flat, n);
+
+  return 0;
+}
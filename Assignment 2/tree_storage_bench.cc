@@ -0,0 +1,74 @@
+#include "BinaryTree.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace std;
+
+/* Resident memory of this process, in bytes */
+long resident_bytes()
+{
+  long pages = 0, resident = 0;
+  ifstream statm("/proc/self/statm");
+  statm >> pages >> resident;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+long sum;
+void add(const int &x) { sum += x; }
+
+/* Time of 'f' in milliseconds */
+template <class F>
+double ms(F f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  auto stop = chrono::steady_clock::now();
+  return chrono::duration_cast<chrono::duration<double, milli> >(stop - start).count();
+}
+
+/* Build a tree of 'n' nodes and time its traversals */
+template <class Tree>
+void run(const char *name, const vector<int> &elements)
+{
+  int n = elements.size();
+  long before = resident_bytes();
+  Tree *tree = new Tree;
+  double build = ms([&]
+                    { tree->init_complete(const_cast<int *>(&elements[0]), n); });
+  long bytes = resident_bytes() - before;
+
+  double pre = ms([&]
+                  { sum = 0; tree->preorder(add); });
+  long check = sum;
+  double in = ms([&]
+                 { sum = 0; tree->inorder(add); });
+  double count = ms([&]
+                    { sum = tree->node_count(); });
+  double height = ms([&]
+                     { sum = tree->height(); });
+  if (check != (long)n * (n - 1) / 2)
+    cerr << name << ": wrong sum\n";
+
+  cout << name << "\t" << bytes / 1e6 << " MB (" << double(bytes) / n << " B/node)\tbuild " << build
+       << " ms\tpreorder " << pre << " ms\tinorder " << in << " ms\tnode_count " << count
+       << " ms\theight " << height << " ms\n";
+  delete tree;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+  vector<int> elements(n);
+  for (int i = 0; i < n; ++i)
+    elements[i] = i;
+
+  cout << "Complete tree of " << n << " ints\n";
+  run<BinaryTree<int, FlatStorage> >("flat  ", elements);
+  run<BinaryTree<int> >("linked", elements);
+
+  return 0;
+}